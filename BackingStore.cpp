@@ -0,0 +1,133 @@
+#include "BackingStore.h"
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+bool BackingStore::open(const std::string &path, size_t slots, size_t size)
+{
+    close();
+
+    size_t bytes = slots * size;
+    if (bytes == 0)
+        return false;
+
+#ifdef _WIN32
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr,
+                             CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+        return false;
+
+    uint64_t fileBytes = bytes;
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READWRITE,
+                                       static_cast<DWORD>(fileBytes >> 32),
+                                       static_cast<DWORD>(fileBytes & 0xFFFFFFFF), nullptr);
+    if (mappingHandle != nullptr)
+    {
+        view = static_cast<char *>(MapViewOfFile(mappingHandle, FILE_MAP_ALL_ACCESS, 0, 0, bytes));
+    }
+#else
+    fileDescriptor = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fileDescriptor < 0)
+        return false;
+
+    if (ftruncate(fileDescriptor, static_cast<off_t>(bytes)) == 0)
+    {
+        void *mapped = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+        view = mapped == MAP_FAILED ? nullptr : static_cast<char *>(mapped);
+    }
+#endif
+
+    if (!view)
+    {
+        close();
+        return false;
+    }
+
+    slotCount = slots;
+    slotSize = size;
+
+    // Popped from the back, so low slots are handed out first
+    freeSlots.clear();
+    freeSlots.reserve(slotCount);
+    for (size_t slot = slotCount; slot > 0; --slot)
+    {
+        freeSlots.push_back(static_cast<uint32_t>(slot - 1));
+    }
+    return true;
+}
+
+void BackingStore::close()
+{
+#ifdef _WIN32
+    if (view)
+    {
+        UnmapViewOfFile(view);
+    }
+    if (mappingHandle)
+    {
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+    }
+    if (fileHandle != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(fileHandle);
+        fileHandle = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (view)
+    {
+        munmap(view, slotCount * slotSize);
+    }
+    if (fileDescriptor >= 0)
+    {
+        ::close(fileDescriptor);
+        fileDescriptor = -1;
+    }
+#endif
+
+    view = nullptr;
+    slotCount = 0;
+    slotSize = 0;
+    freeSlots.clear();
+}
+
+uint32_t BackingStore::allocateSlot()
+{
+    if (freeSlots.empty())
+        return NO_SLOT;
+
+    uint32_t slot = freeSlots.back();
+    freeSlots.pop_back();
+    return slot;
+}
+
+void BackingStore::freeSlot(uint32_t slot)
+{
+    freeSlots.push_back(slot);
+}
+
+void BackingStore::write(uint32_t slot, const char *page)
+{
+    std::memcpy(view + static_cast<size_t>(slot) * slotSize, page, slotSize);
+}
+
+void BackingStore::read(uint32_t slot, char *page) const
+{
+    std::memcpy(page, view + static_cast<size_t>(slot) * slotSize, slotSize);
+}
+
+void BackingStore::flush()
+{
+    if (!view)
+        return;
+
+#ifdef _WIN32
+    FlushViewOfFile(view, 0);
+#else
+    msync(view, slotCount * slotSize, MS_ASYNC);
+#endif
+}
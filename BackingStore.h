@@ -0,0 +1,53 @@
+#ifndef BACKING_STORE_H
+#define BACKING_STORE_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+// Swap space for paging mode: a file of fixed-size page slots mapped into the
+// address space (MapViewOfFile on Windows, mmap elsewhere), so swapping a page
+// is a memcpy and the OS writes the dirty view back in the background. Slot
+// bookkeeping is not synchronized; MemoryManager calls allocateSlot and
+// freeSlot under its lock, and only the pager copies page contents.
+class BackingStore
+{
+public:
+    static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+    ~BackingStore() { close(); }
+
+    bool open(const std::string &path, size_t slots, size_t slotSize);
+    void close();
+    bool isOpen() const { return view != nullptr; }
+
+    uint32_t allocateSlot(); // NO_SLOT when the file is full
+    void freeSlot(uint32_t slot);
+    size_t getSlotCount() const { return slotCount; }
+    size_t getFreeSlots() const { return freeSlots.size(); }
+
+    void write(uint32_t slot, const char *page);
+    void read(uint32_t slot, char *page) const;
+
+    // Starts writing dirty pages of the view back without waiting for it
+    void flush();
+
+private:
+#ifdef _WIN32
+    HANDLE fileHandle{INVALID_HANDLE_VALUE};
+    HANDLE mappingHandle{nullptr};
+#else
+    int fileDescriptor{-1};
+#endif
+    char *view{nullptr};
+    size_t slotCount{0};
+    size_t slotSize{0};
+    std::vector<uint32_t> freeSlots;
+};
+
+#endif
@@ -0,0 +1,121 @@
+#include "BuddyAllocator.h"
+
+void BuddyAllocator::reset(size_t frames, size_t)
+{
+    totalFrames = frames;
+    freeFrames = 0;
+    largestFree = 0;
+    clearFreeRuns();
+
+    freeLists.assign(orderFor(frames > 0 ? frames : 1) + 1, std::set<size_t>());
+
+    // Carve the range into the largest aligned power-of-two blocks
+    size_t start = 0;
+    while (start < totalFrames)
+    {
+        size_t order = 0;
+        while (start % (size_t{2} << order) == 0 && start + (size_t{2} << order) <= totalFrames)
+        {
+            ++order;
+        }
+        insertBlock(start, order);
+        start += size_t{1} << order;
+    }
+}
+
+size_t BuddyAllocator::allocate(size_t frames)
+{
+    if (frames == 0)
+        return npos;
+
+    size_t order = orderFor(frames);
+    size_t available = order;
+    while (available < freeLists.size() && freeLists[available].empty())
+    {
+        ++available;
+    }
+    if (available >= freeLists.size())
+        return npos;
+
+    size_t start = *freeLists[available].begin();
+    eraseBlock(start, available);
+
+    // Keep the low half, free the high half, until the block is the right size
+    while (available > order)
+    {
+        --available;
+        insertBlock(start + (size_t{1} << available), available);
+    }
+    return start;
+}
+
+void BuddyAllocator::release(size_t start, size_t frames)
+{
+    if (frames == 0)
+        return;
+
+    size_t order = orderFor(frames);
+    while (order + 1 < freeLists.size())
+    {
+        size_t buddy = start ^ (size_t{1} << order);
+        auto free = freeLists[order].find(buddy);
+        if (free == freeLists[order].end())
+            break;
+
+        eraseBlock(buddy, order);
+        start = start < buddy ? start : buddy;
+        ++order;
+    }
+    insertBlock(start, order);
+}
+
+size_t BuddyAllocator::getFragmentedFrames(size_t frames) const
+{
+    // A request is served from its own order or above
+    size_t requestOrder = orderFor(frames > 0 ? frames : 1);
+    size_t fragmented = 0;
+    for (size_t order = 0; order < requestOrder && order < freeLists.size(); ++order)
+    {
+        fragmented += freeLists[order].size() << order;
+    }
+    return fragmented;
+}
+
+size_t BuddyAllocator::orderFor(size_t frames)
+{
+    size_t order = 0;
+    while ((size_t{1} << order) < frames)
+    {
+        ++order;
+    }
+    return order;
+}
+
+void BuddyAllocator::insertBlock(size_t start, size_t order)
+{
+    freeLists[order].insert(start);
+    freeFrames += size_t{1} << order;
+    addFreeRun(size_t{1} << order);
+    if ((size_t{1} << order) > largestFree)
+    {
+        largestFree = size_t{1} << order;
+    }
+}
+
+void BuddyAllocator::eraseBlock(size_t start, size_t order)
+{
+    freeLists[order].erase(start);
+    freeFrames -= size_t{1} << order;
+    removeFreeRun(size_t{1} << order);
+
+    // Only emptying the top order moves the largest block down
+    if (freeLists[order].empty() && (size_t{1} << order) == largestFree)
+    {
+        largestFree = 0;
+        for (size_t lower = order; lower > 0 && largestFree == 0; --lower)
+        {
+            if (!freeLists[lower - 1].empty())
+                largestFree = size_t{1} << (lower - 1);
+        }
+    }
+}
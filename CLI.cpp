@@ -2,6 +2,7 @@
 #include <iostream>
 #include <sstream>
 #include "Config.h"
+#include "MemoryManager.h"
 #include <thread>
 #include <chrono>
 #include <iomanip>
@@ -45,6 +46,7 @@ void CLI::start()
             {
                 clearScreen();
                 currentScreen = "main";
+                screenProcess.reset();
                 displayHeader();
                 continue;
             }
@@ -108,7 +110,38 @@ void CLI::handleCommand(const std::string &command)
         }
         else if (cmd == "report-util")
         {
-            Scheduler::getInstance().getCPUUtilization();
+            size_t page = 0;
+            iss >> page;
+            Scheduler::getInstance().getCPUUtilization(page);
+        }
+        else if (cmd == "latency-stats")
+        {
+            Scheduler::getInstance().printLatencyStatistics();
+        }
+        else if (cmd == "vmstat")
+        {
+            MemoryManager::getInstance().printVirtualMemoryStats();
+        }
+        else if (cmd == "renice")
+        {
+            std::string processName;
+            int niceValue;
+            if (!(iss >> processName >> niceValue))
+            {
+                std::cout << "Usage: renice <process> <nice value from -20 to 19>\n";
+                return;
+            }
+
+            auto process = ProcessManager::getInstance().getProcess(processName);
+            if (process)
+            {
+                Scheduler::getInstance().reniceProcess(*process, niceValue);
+                std::cout << processName << " nice value set to " << process->getNice() << "\n";
+            }
+            else
+            {
+                std::cout << "Process " << processName << " not found.\n";
+            }
         }
         else if (cmd != "exit")
         {
@@ -119,10 +152,11 @@ void CLI::handleCommand(const std::string &command)
     {
         if (cmd == "process-smi")
         {
-            auto process = ProcessManager::getInstance().getProcess(currentScreen);
-            if (process)
+            // The screen holds its own reference, so a process that has
+            // finished (and left ProcessManager) still reports Finished!
+            if (screenProcess)
             {
-                process->displayProcessInfo();
+                screenProcess->displayProcessInfo();
             }
             else
             {
@@ -165,30 +199,27 @@ void CLI::handleScreenCommand(const std::string &flag, const std::string &proces
             return;
         }
 
+        // ProcessManager forgets finished processes, so their names are
+        // checked against the finished history here; screen -s is typed by
+        // hand, so scanning the archive is affordable, unlike for every
+        // batch-generated process
+        if (Scheduler::getInstance().getFinishedHistory().contains(processName))
+        {
+            std::cout << "Process " << processName << " already exists and has finished.\n";
+            return;
+        }
+
         try
         {
-            ProcessManager::getInstance().createProcess(processName);
-            clearScreen();
+            screenProcess = ProcessManager::getInstance().createProcess(processName);
             currentScreen = processName;
-
-            std::cout << "\n================================\n";
-            std::cout << "Process Screen: " << processName << "\n";
-            std::cout << "================================\n";
-            std::cout << "Available commands:\n";
-            std::cout << "  process-smi - Show process information\n";
-            std::cout << "  exit       - Return to main menu\n";
-            std::cout << "================================\n\n";
-
-            auto process = ProcessManager::getInstance().getProcess(processName);
-            if (process)
-            {
-                process->displayProcessInfo();
-            }
+            displayProcessScreen(processName);
         }
         catch (const std::exception &e)
         {
             std::cerr << "Error in screen command: " << e.what() << std::endl;
             currentScreen = "main";
+            screenProcess.reset();
         }
     }
     else if (flag == "-r")
@@ -196,18 +227,9 @@ void CLI::handleScreenCommand(const std::string &flag, const std::string &proces
         auto process = ProcessManager::getInstance().getProcess(processName);
         if (process && process->getState() != Process::FINISHED)
         {
-            clearScreen();
+            screenProcess = process;
             currentScreen = processName;
-
-            std::cout << "\n================================\n";
-            std::cout << "Process Screen: " << processName << "\n";
-            std::cout << "================================\n";
-            std::cout << "Available commands:\n";
-            std::cout << "  process-smi - Show process information\n";
-            std::cout << "  exit       - Return to main menu\n";
-            std::cout << "================================\n\n";
-
-            process->displayProcessInfo();
+            displayProcessScreen(processName);
         }
         else
         {
@@ -216,7 +238,10 @@ void CLI::handleScreenCommand(const std::string &flag, const std::string &proces
     }
     else if (flag == "-ls")
     {
-        ProcessManager::getInstance().listProcesses();
+        // An optional page number follows -ls
+        size_t page = 0;
+        std::istringstream(processName) >> page;
+        ProcessManager::getInstance().listProcesses(page);
     }
 }
 
@@ -232,10 +257,9 @@ void CLI::displayProcessScreen(const std::string &processName)
     std::cout << "  exit       - Return to main menu\n";
     std::cout << "================================\n\n";
 
-    auto process = ProcessManager::getInstance().getProcess(processName);
-    if (process)
+    if (screenProcess)
     {
-        process->displayProcessInfo();
+        screenProcess->displayProcessInfo();
     }
 }
 
@@ -23,6 +23,7 @@ private:
 
     bool initialized;
     std::string currentScreen;
+    std::shared_ptr<Process> screenProcess; // Kept while its screen is open, even once finished
 
     void displayHeader();
     void clearScreen();
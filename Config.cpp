@@ -1,6 +1,8 @@
 #include "Config.h"
 #include <fstream>
 #include <iostream>
+#include <sstream>
+#include <thread>
 
 void Config::loadConfig(const std::string &filename)
 {
@@ -22,56 +24,12 @@ void Config::loadConfig(const std::string &filename)
     std::string param;
     while (file >> param)
     {
-        if (param == "num-cpu")
-        {
-            file >> numCPU;
-            requiredParams[param] = true;
-        }
-        else if (param == "scheduler")
-        {
-            file >> schedulerType;
-            requiredParams[param] = true;
-        }
-        else if (param == "quantum-cycles")
-        {
-            file >> quantumCycles;
-            requiredParams[param] = true;
-        }
-        else if (param == "batch-process-freq")
-        {
-            file >> batchProcessFreq;
-            requiredParams[param] = true;
-        }
-        else if (param == "min-ins")
-        {
-            file >> minInstructions;
-            requiredParams[param] = true;
-        }
-        else if (param == "max-ins")
-        {
-            file >> maxInstructions;
-            requiredParams[param] = true;
-        }
-        else if (param == "delays-per-exec")
-        {
-            file >> delaysPerExec;
-            requiredParams[param] = true;
-        }
-        else if (param == "max-overall-mem")
-        {
-            file >> maxOverallMem;
-        }
-        else if (param == "mem-per-frame")
-        {
-            file >> memPerFrame;
-        }
-        else if (param == "mem-per-proc")
-        {
-            file >> memPerProc;
-        }
-        else
+        readParameter(param, file);
+
+        auto required = requiredParams.find(param);
+        if (required != requiredParams.end())
         {
-            throw ConfigException("Unknown parameter: " + param);
+            required->second = true;
         }
     }
 
@@ -88,6 +46,185 @@ void Config::loadConfig(const std::string &filename)
     initialized = true;
 }
 
+void Config::setParameter(const std::string &param, const std::string &value)
+{
+    std::istringstream in(value);
+    readParameter(param, in);
+}
+
+void Config::readParameter(const std::string &param, std::istream &in)
+{
+    if (param == "num-cpu")
+    {
+        in >> numCPU;
+    }
+    else if (param == "scheduler")
+    {
+        in >> schedulerType;
+    }
+    else if (param == "quantum-cycles")
+    {
+        in >> quantumCycles;
+    }
+    else if (param == "batch-process-freq")
+    {
+        in >> batchProcessFreq;
+    }
+    else if (param == "min-ins")
+    {
+        in >> minInstructions;
+    }
+    else if (param == "max-ins")
+    {
+        in >> maxInstructions;
+    }
+    else if (param == "delays-per-exec")
+    {
+        // Read signed so a negative value is rejected instead of wrapping
+        long long delays = 0;
+        in >> delays;
+        if (delays < 0 || delays > UINT32_MAX)
+        {
+            throw ConfigException("Invalid delays per execution (must be between 0 and 4294967295): " + std::to_string(delays));
+        }
+        delaysPerExec = static_cast<uint32_t>(delays);
+    }
+    else if (param == "max-overall-mem")
+    {
+        in >> maxOverallMem;
+    }
+    else if (param == "mem-per-frame")
+    {
+        in >> memPerFrame;
+    }
+    else if (param == "mem-per-proc")
+    {
+        in >> memPerProc;
+    }
+    else if (param == "max-mem-per-proc")
+    {
+        in >> maxMemPerProc;
+    }
+    else if (param == "clock-mode")
+    {
+        in >> clockMode;
+    }
+    else if (param == "exec-mode")
+    {
+        in >> execMode;
+    }
+    else if (param == "memory-snapshots")
+    {
+        in >> memorySnapshots;
+    }
+    else if (param == "snapshot-log")
+    {
+        in >> snapshotLog;
+    }
+    else if (param == "memory-mode")
+    {
+        in >> memoryMode;
+    }
+    else if (param == "placement")
+    {
+        in >> placement;
+    }
+    else if (param == "compaction-frames")
+    {
+        in >> compactionFrames;
+    }
+    else if (param == "swap-file")
+    {
+        in >> swapFile;
+    }
+    else if (param == "swap-size")
+    {
+        in >> swapSize;
+    }
+    else if (param == "page-replacement")
+    {
+        in >> pageReplacement;
+    }
+    else if (param == "trace-file")
+    {
+        in >> traceFile;
+    }
+    else if (param == "finished-retention")
+    {
+        in >> finishedRetention;
+    }
+    else if (param == "finished-archive")
+    {
+        in >> finishedArchive;
+    }
+    else if (param == "host-threads")
+    {
+        in >> hostThreads;
+    }
+    else if (param == "workload-seed")
+    {
+        in >> workloadSeed;
+    }
+    else if (param == "mlfq-levels")
+    {
+        in >> mlfqLevels;
+    }
+    else if (param == "mlfq-quanta")
+    {
+        // Comma separated, e.g. "mlfq-quanta 2,4,8"
+        std::string list;
+        in >> list;
+        std::stringstream ss(list);
+        std::string value;
+        mlfqQuanta.clear();
+        while (std::getline(ss, value, ','))
+        {
+            unsigned long quantum = 0;
+            try
+            {
+                if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos)
+                    throw std::invalid_argument(value);
+                quantum = std::stoul(value);
+            }
+            catch (const std::exception &)
+            {
+                throw ConfigException("Invalid MLFQ quanta (must be comma separated numbers): " + list);
+            }
+            if (quantum > UINT32_MAX)
+            {
+                throw ConfigException("Invalid MLFQ quantum (too large): " + value);
+            }
+            mlfqQuanta.push_back(static_cast<uint32_t>(quantum));
+        }
+        mlfqQuantaGiven = true;
+    }
+    else if (param == "mlfq-boost-cycles")
+    {
+        in >> mlfqBoostCycles;
+    }
+    else if (param == "cfs-target-latency")
+    {
+        in >> cfsTargetLatency;
+    }
+    else if (param == "cfs-min-granularity")
+    {
+        in >> cfsMinGranularity;
+    }
+    else
+    {
+        throw ConfigException("Unknown parameter: " + param);
+    }
+}
+
+unsigned int Config::getHostThreads() const
+{
+    if (hostThreads > 0)
+        return hostThreads;
+
+    unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    return hardwareThreads > 0 ? hardwareThreads : 1;
+}
+
 void Config::validateParameters()
 {
     if (numCPU < 1 || numCPU > 128)
@@ -95,9 +232,73 @@ void Config::validateParameters()
         throw ConfigException("Invalid number of CPUs (must be between 1 and 128): " + std::to_string(numCPU));
     }
 
-    if (schedulerType != "fcfs" && schedulerType != "rr")
+    if (schedulerType == "fcfs")
+    {
+        schedulerPolicy = FCFS;
+    }
+    else if (schedulerType == "rr")
+    {
+        schedulerPolicy = ROUND_ROBIN;
+    }
+    else if (schedulerType == "mlfq")
+    {
+        schedulerPolicy = MLFQ;
+    }
+    else if (schedulerType == "sjf")
+    {
+        schedulerPolicy = SJF;
+    }
+    else if (schedulerType == "srtf")
+    {
+        schedulerPolicy = SRTF;
+    }
+    else if (schedulerType == "cfs")
+    {
+        schedulerPolicy = CFS;
+    }
+    else
+    {
+        throw ConfigException("Invalid scheduler type (must be 'fcfs', 'rr', 'mlfq', 'sjf', 'srtf' or 'cfs'): " + schedulerType);
+    }
+
+    if (clockMode != "realtime" && clockMode != "virtual")
+    {
+        throw ConfigException("Invalid clock mode (must be either 'realtime' or 'virtual'): " + clockMode);
+    }
+
+    if (execMode != "cycle" && execMode != "slice")
+    {
+        throw ConfigException("Invalid exec mode (must be either 'cycle' or 'slice'): " + execMode);
+    }
+
+    if (memorySnapshots != "on" && memorySnapshots != "off")
+    {
+        throw ConfigException("Invalid memory snapshots setting (must be either 'on' or 'off'): " + memorySnapshots);
+    }
+
+    if (memoryMode != "flat" && memoryMode != "paging")
+    {
+        throw ConfigException("Invalid memory mode (must be either 'flat' or 'paging'): " + memoryMode);
+    }
+
+    if (placement != "first" && placement != "next" && placement != "best" && placement != "worst" && placement != "buddy")
     {
-        throw ConfigException("Invalid scheduler type (must be either 'fcfs' or 'rr'): " + schedulerType);
+        throw ConfigException("Invalid placement (must be 'first', 'next', 'best', 'worst' or 'buddy'): " + placement);
+    }
+
+    if (pageReplacement != "fifo" && pageReplacement != "lru" && pageReplacement != "clock")
+    {
+        throw ConfigException("Invalid page replacement (must be 'fifo', 'lru' or 'clock'): " + pageReplacement);
+    }
+
+    if (!swapFile.empty() && memoryMode != "paging")
+    {
+        throw ConfigException("swap-file needs memory-mode paging");
+    }
+
+    if (!swapFile.empty() && swapSize < memPerFrame)
+    {
+        throw ConfigException("Invalid swap size (must be at least mem-per-frame): " + std::to_string(swapSize));
     }
 
     if (quantumCycles < 1)
@@ -105,6 +306,55 @@ void Config::validateParameters()
         throw ConfigException("Invalid quantum cycles (must be at least 1): " + std::to_string(quantumCycles));
     }
 
+    if (finishedRetention < 1)
+    {
+        throw ConfigException("Invalid finished retention (must be at least 1): " + std::to_string(finishedRetention));
+    }
+
+    if (mlfqLevels < 1 || mlfqLevels > 8)
+    {
+        throw ConfigException("Invalid MLFQ levels (must be between 1 and 8): " + std::to_string(mlfqLevels));
+    }
+
+    // The quanta only matter to mlfq, so other schedulers take any quantum-cycles
+    if (schedulerPolicy == MLFQ)
+    {
+        // Defaults follow quantum-cycles and mlfq-levels, whichever was set last
+        if (!mlfqQuantaGiven)
+        {
+            mlfqQuanta.clear();
+            for (uint32_t level = 0; level < mlfqLevels; ++level)
+            {
+                uint64_t quantum = static_cast<uint64_t>(quantumCycles) << level;
+                if (quantum > UINT32_MAX)
+                {
+                    throw ConfigException("Invalid MLFQ quantum (too large): level " + std::to_string(level) + " would get " +
+                                          std::to_string(quantum) + " cycles, set mlfq-quanta or a smaller quantum-cycles");
+                }
+                mlfqQuanta.push_back(static_cast<uint32_t>(quantum));
+            }
+        }
+
+        if (mlfqQuanta.size() != mlfqLevels)
+        {
+            throw ConfigException("MLFQ quanta must list one value per level: expected " + std::to_string(mlfqLevels) +
+                                  ", got " + std::to_string(mlfqQuanta.size()));
+        }
+
+        for (uint32_t quantum : mlfqQuanta)
+        {
+            if (quantum < 1)
+            {
+                throw ConfigException("Invalid MLFQ quantum (must be at least 1)");
+            }
+        }
+    }
+
+    if (cfsMinGranularity < 1 || cfsMinGranularity > cfsTargetLatency)
+    {
+        throw ConfigException("Invalid CFS min granularity (must be between 1 and cfs-target-latency): " + std::to_string(cfsMinGranularity));
+    }
+
     if (batchProcessFreq < 1)
     {
         throw ConfigException("Invalid batch process frequency (must be at least 1): " + std::to_string(batchProcessFreq));
@@ -120,11 +370,6 @@ void Config::validateParameters()
         throw ConfigException("Invalid maximum instructions (must be greater than or equal to min-ins): " + std::to_string(maxInstructions));
     }
 
-    if (delaysPerExec < 0)
-    {
-        throw ConfigException("Invalid delays per execution (must be non-negative): " + std::to_string(delaysPerExec));
-    }
-
     if (maxOverallMem <= 0)
     {
         throw ConfigException("Max overall memory must be greater than 0");
@@ -160,4 +405,20 @@ void Config::validateParameters()
     {
         throw ConfigException("Frame size cannot be larger than process memory");
     }
+
+    if (maxMemPerProc > 0)
+    {
+        if (maxMemPerProc < memPerProc)
+        {
+            throw ConfigException("Max process memory cannot be smaller than mem-per-proc");
+        }
+        if (maxMemPerProc % memPerFrame != 0)
+        {
+            throw ConfigException("Max process memory must be multiple of frame size");
+        }
+        if (maxMemPerProc > maxOverallMem)
+        {
+            throw ConfigException("Max process memory cannot be larger than total memory");
+        }
+    }
 }
\ No newline at end of file
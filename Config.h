@@ -5,10 +5,22 @@
 #include <stdexcept>
 #include <cstdint>
 #include <map>
+#include <vector>
+#include <istream>
 
 class Config
 {
 public:
+    enum SchedulerPolicy
+    {
+        FCFS,
+        ROUND_ROBIN,
+        MLFQ,
+        SJF,
+        SRTF,
+        CFS
+    };
+
     // This allows only one instance of Config to exist
     static Config &getInstance()
     {
@@ -17,11 +29,20 @@ public:
     }
 
     void loadConfig(const std::string &filename);
+
+    // Overrides one parameter after loading, e.g. from benchmark flags. It
+    // only assigns: call validateParameters once every override is in, since
+    // the limits depend on each other (mem-per-proc on max-overall-mem, and
+    // so on) and the overrides can come in any order.
+    void setParameter(const std::string &param, const std::string &value);
+    void validateParameters();
     bool isInitialized() const { return initialized; }
 
     // Getters
     int getNumCPU() const { return numCPU; }
-    std::string getSchedulerType() const { return schedulerType; }
+    unsigned int getHostThreads() const;
+    const std::string &getSchedulerType() const { return schedulerType; }
+    SchedulerPolicy getSchedulerPolicy() const { return schedulerPolicy; }
     uint32_t getQuantumCycles() const { return quantumCycles; }
     uint32_t getBatchProcessFreq() const { return batchProcessFreq; }
     uint32_t getMinInstructions() const { return minInstructions; }
@@ -30,6 +51,39 @@ public:
     uint32_t getMaxOverallMem() const { return maxOverallMem; }
     uint32_t getMemPerFrame() const { return memPerFrame; }
     uint32_t getMemPerProc() const { return memPerProc; }
+    uint32_t getMaxMemPerProc() const { return maxMemPerProc > 0 ? maxMemPerProc : memPerProc; }
+    bool isVirtualClock() const { return clockMode == "virtual"; }
+    bool isSliceBatching() const { return execMode == "slice"; }
+    bool areMemorySnapshotsEnabled() const { return memorySnapshots == "on"; }
+    const std::string &getSnapshotLog() const { return snapshotLog; }
+    const std::string &getMemoryMode() const { return memoryMode; }
+    bool isPagingEnabled() const { return memoryMode == "paging"; }
+
+    // Paging mode backing store, empty file name = no swapping
+    const std::string &getSwapFile() const { return swapFile; }
+    uint32_t getSwapSize() const { return swapSize; }
+    const std::string &getPageReplacement() const { return pageReplacement; }
+
+    // Flat mode placement strategy, and frames compaction may move per cycle (0 = off)
+    const std::string &getPlacement() const { return placement; }
+    uint32_t getCompactionFrames() const { return compactionFrames; }
+    const std::string &getTraceFile() const { return traceFile; }
+
+    // Finished processes kept in memory; older ones go to the archive file
+    uint32_t getFinishedRetention() const { return finishedRetention; }
+    const std::string &getFinishedArchive() const { return finishedArchive; }
+
+    // Seed for generated instruction counts, 0 means nondeterministic
+    uint32_t getWorkloadSeed() const { return workloadSeed; }
+
+    // Multi-level feedback queue
+    uint32_t getMLFQLevels() const { return mlfqLevels; }
+    const std::vector<uint32_t> &getMLFQQuanta() const { return mlfqQuanta; }
+    uint32_t getMLFQBoostCycles() const { return mlfqBoostCycles; }
+
+    // Completely fair scheduler
+    uint32_t getCFSTargetLatency() const { return cfsTargetLatency; }
+    uint32_t getCFSMinGranularity() const { return cfsMinGranularity; }
 
     // Exception class for Config
     class ConfigException : public std::runtime_error
@@ -42,7 +96,8 @@ private:
     Config() : initialized(false) {}
 
     int numCPU;                // Range: [1, 128]
-    std::string schedulerType; // fcfs or rr
+    std::string schedulerType; // fcfs, rr, mlfq, sjf, srtf or cfs
+    SchedulerPolicy schedulerPolicy{FCFS};
     uint32_t quantumCycles;    // Range: [1, 2^32]
     uint32_t batchProcessFreq; // Range: [1, 2^32]
     uint32_t minInstructions;  // Range: [1, 2^32]
@@ -53,8 +108,33 @@ private:
     uint32_t maxOverallMem{16384}; // 16KB
     uint32_t memPerFrame{16};      // 16 bytes per frame
     uint32_t memPerProc{4096};     // 4KB per proces
+    uint32_t maxMemPerProc{0};     // Sizes drawn from [mem-per-proc, this], 0 = all mem-per-proc
 
-    void validateParameters();
+    std::string clockMode{"realtime"}; // realtime or virtual
+    uint32_t hostThreads{0};           // Host workers stepping the cores, 0 = hardware concurrency
+    std::string execMode{"cycle"};     // cycle (sync every cycle) or slice (sync once per batch)
+    std::string memorySnapshots{"on"}; // on or off
+    std::string snapshotLog{"memory-snapshots.bin"}; // Binary log of the memory snapshots
+    std::string memoryMode{"flat"};    // flat (one contiguous block) or paging (demand paged frames)
+    std::string placement{"first"};    // first, next, best, worst or buddy
+    uint32_t compactionFrames{64};     // Range: [0, 2^32]
+    std::string swapFile;              // Memory-mapped swap file, paging mode only
+    uint32_t swapSize{65536};          // Bytes of swap space, Range: [mem-per-frame, 2^32]
+    std::string pageReplacement{"fifo"}; // fifo, lru or clock
+    std::string traceFile;             // Binary scheduler trace, empty = tracing off
+    uint32_t finishedRetention{1000};  // Range: [1, 2^32]
+    std::string finishedArchive{"finished-processes.bin"};
+    uint32_t workloadSeed{0};
+
+    uint32_t mlfqLevels{3};           // Range: [1, 8]
+    std::vector<uint32_t> mlfqQuanta; // One per level, defaults to quantum-cycles doubled per level
+    bool mlfqQuantaGiven{false};      // Set by mlfq-quanta; otherwise mlfq rebuilds the defaults on every validation
+    uint32_t mlfqBoostCycles{1000};   // 0 disables the priority boost
+
+    uint32_t cfsTargetLatency{24};  // Cycles in which every runnable process should run once
+    uint32_t cfsMinGranularity{3};  // Shortest slice handed out, Range: [1, target latency]
+
+    void readParameter(const std::string &param, std::istream &in);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,88 @@
+#include "CycleBarrier.h"
+
+CycleBarrier::CycleBarrier(std::function<bool()> onActivate, std::function<bool()> onPhaseComplete)
+    : onActivate(std::move(onActivate)), onPhaseComplete(std::move(onPhaseComplete))
+{
+}
+
+bool CycleBarrier::activate()
+{
+    std::lock_guard<std::mutex> lock(barrierMutex);
+    if (active || released)
+        return active;
+
+    if (onActivate())
+    {
+        active.store(true, std::memory_order_release);
+        stateCv.notify_all();
+    }
+    return active;
+}
+
+void CycleBarrier::arriveAndWait()
+{
+    std::unique_lock<std::mutex> lock(barrierMutex);
+    if (released)
+        return;
+
+    if (++arrived >= participants)
+    {
+        arrived = 0;
+        if (!onPhaseComplete())
+        {
+            active.store(false, std::memory_order_release);
+            stateCv.notify_all();
+        }
+        ++phase;
+        phaseCv.notify_all();
+        return;
+    }
+
+    uint64_t myPhase = phase;
+    phaseCv.wait(lock, [this, myPhase]
+                 { return phase != myPhase || released; });
+}
+
+bool CycleBarrier::runIfIdle(const std::function<void()> &fn)
+{
+    std::lock_guard<std::mutex> lock(barrierMutex);
+    if (active)
+        return false;
+
+    fn();
+    return true;
+}
+
+void CycleBarrier::waitUntilIdle(const std::function<bool()> &stop)
+{
+    std::unique_lock<std::mutex> lock(barrierMutex);
+    stateCv.wait(lock, [this, &stop]
+                 { return !active || released || stop(); });
+}
+
+bool CycleBarrier::waitWhileIdle(std::chrono::milliseconds timeout, const std::function<bool()> &stop)
+{
+    std::unique_lock<std::mutex> lock(barrierMutex);
+    bool interrupted = stateCv.wait_for(lock, timeout, [this, &stop]
+                                        { return active || released || stop(); });
+    return !interrupted;
+}
+
+void CycleBarrier::release()
+{
+    {
+        std::lock_guard<std::mutex> lock(barrierMutex);
+        released = true;
+    }
+    phaseCv.notify_all();
+    stateCv.notify_all();
+}
+
+void CycleBarrier::reset(size_t participants)
+{
+    std::lock_guard<std::mutex> lock(barrierMutex);
+    this->participants = participants;
+    arrived = 0;
+    released = false;
+    active = false;
+}
@@ -0,0 +1,59 @@
+#ifndef CYCLE_BARRIER_H
+#define CYCLE_BARRIER_H
+
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <atomic>
+#include <cstdint>
+
+// Reusable phase barrier that keeps the cores in lock-step. Every host
+// worker takes part in every phase of a busy period, whether or not its own
+// cores have anything to run, so the phases never depend on how the cores
+// are spread over the workers. When the last worker arrives, the completion
+// step runs exactly once (still under the barrier lock) and then every
+// waiter is released with a single notify. The completion step ends the busy
+// period by returning false; a worker that later sees work starts the next
+// one with activate.
+class CycleBarrier
+{
+public:
+    // Both steps run under the barrier lock and return whether the cores
+    // are busy, i.e. whether another phase should follow
+    CycleBarrier(std::function<bool()> onActivate, std::function<bool()> onPhaseComplete);
+
+    // Starts a busy period unless one is running. Returns whether one is.
+    bool activate();
+    bool isActive() const { return active.load(std::memory_order_acquire); }
+    void arriveAndWait();
+
+    // Runs fn under the barrier lock if no busy period is running, so idle
+    // ticks can never interleave with a phase completed by the cores
+    bool runIfIdle(const std::function<void()> &fn);
+
+    // Blocks while a busy period is running
+    void waitUntilIdle(const std::function<bool()> &stop);
+
+    // Blocks up to timeout while idle. Returns false if a busy period
+    // started (or stop became true) before the timeout ran out.
+    bool waitWhileIdle(std::chrono::milliseconds timeout, const std::function<bool()> &stop);
+
+    // Wakes every waiter for shutdown; later arrivals return immediately
+    void release();
+    void reset(size_t participants);
+
+private:
+    std::mutex barrierMutex;
+    std::condition_variable phaseCv;
+    std::condition_variable stateCv; // A busy period started or ended
+    size_t participants{1};
+    size_t arrived{0};
+    uint64_t phase{0};
+    bool released{false};
+    std::atomic<bool> active{false};
+    std::function<bool()> onActivate;
+    std::function<bool()> onPhaseComplete;
+};
+
+#endif
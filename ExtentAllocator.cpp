@@ -0,0 +1,312 @@
+#include "ExtentAllocator.h"
+#include <iterator>
+#include <algorithm>
+
+const char *ExtentAllocator::getName() const
+{
+    switch (strategy)
+    {
+    case NEXT_FIT:
+        return "next";
+    case BEST_FIT:
+        return "best";
+    case WORST_FIT:
+        return "worst";
+    case FIRST_FIT:
+    default:
+        return "first";
+    }
+}
+
+void ExtentAllocator::reset(size_t totalFrames, size_t maxRequestFrames)
+{
+    byStart.clear();
+    bySize.clear();
+    nodes.clear();
+    freeNodes.clear();
+    root = npos;
+    seed = 1;
+    shortFrames.assign(maxRequestFrames > 0 ? maxRequestFrames : 1, 0);
+    clearFreeRuns();
+    freeFrames = 0;
+    rover = 0;
+
+    if (totalFrames > 0)
+    {
+        insertExtent(0, totalFrames);
+    }
+}
+
+size_t ExtentAllocator::allocate(size_t frames)
+{
+    switch (strategy)
+    {
+    case NEXT_FIT:
+        return allocateNextFit(frames);
+    case BEST_FIT:
+        return allocateBestFit(frames);
+    case WORST_FIT:
+        return allocateWorstFit(frames);
+    case FIRST_FIT:
+    default:
+        return allocateFirstFit(frames);
+    }
+}
+
+size_t ExtentAllocator::allocateFirstFit(size_t frames)
+{
+    if (frames == 0 || !canFit(frames))
+        return npos;
+
+    size_t start = findFit(root, 0, frames);
+    return takeFrom(start, byStart[start], frames);
+}
+
+size_t ExtentAllocator::allocateBestFit(size_t frames)
+{
+    if (frames == 0)
+        return npos;
+
+    auto best = bySize.lower_bound({frames, 0});
+    if (best == bySize.end())
+        return npos;
+
+    return takeFrom(best->second, best->first, frames);
+}
+
+size_t ExtentAllocator::allocateNextFit(size_t frames)
+{
+    if (frames == 0 || !canFit(frames))
+        return npos;
+
+    // The extent at or after the rover, wrapping around to the lowest one
+    size_t start = findFit(root, rover, frames);
+    if (start == npos)
+    {
+        start = findFit(root, 0, frames);
+    }
+
+    rover = start + frames;
+    return takeFrom(start, byStart[start], frames);
+}
+
+size_t ExtentAllocator::allocateWorstFit(size_t frames)
+{
+    if (frames == 0 || !canFit(frames))
+        return npos;
+
+    // Largest extent, lowest address among equals
+    auto largest = bySize.lower_bound({getLargestFree(), 0});
+    return takeFrom(largest->second, largest->first, frames);
+}
+
+std::pair<size_t, size_t> ExtentAllocator::getLowestExtent() const
+{
+    if (byStart.empty())
+        return {npos, 0};
+    return *byStart.begin();
+}
+
+bool ExtentAllocator::allocateAt(size_t start, size_t frames)
+{
+    if (frames == 0)
+        return true;
+
+    auto extent = byStart.upper_bound(start);
+    if (extent == byStart.begin())
+        return false;
+    --extent;
+
+    size_t extentStart = extent->first;
+    size_t extentLength = extent->second;
+    if (start + frames > extentStart + extentLength)
+        return false;
+
+    // Keep whatever is left on either side free
+    eraseExtent(extentStart, extentLength);
+    if (start > extentStart)
+    {
+        insertExtent(extentStart, start - extentStart);
+    }
+    if (start + frames < extentStart + extentLength)
+    {
+        insertExtent(start + frames, extentStart + extentLength - start - frames);
+    }
+    return true;
+}
+
+void ExtentAllocator::release(size_t start, size_t frames)
+{
+    if (frames == 0)
+        return;
+
+    size_t end = start + frames;
+
+    // Merge with the free neighbours on both sides
+    auto next = byStart.lower_bound(start);
+    if (next != byStart.end() && next->first == end)
+    {
+        end += next->second;
+        eraseExtent(next->first, next->second);
+    }
+
+    next = byStart.lower_bound(start);
+    if (next != byStart.begin())
+    {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == start)
+        {
+            start = previous->first;
+            eraseExtent(previous->first, previous->second);
+        }
+    }
+
+    insertExtent(start, end - start);
+}
+
+size_t ExtentAllocator::takeFrom(size_t start, size_t length, size_t frames)
+{
+    // Allocate from the low end and keep the remainder free
+    eraseExtent(start, length);
+    if (length > frames)
+    {
+        insertExtent(start + frames, length - frames);
+    }
+    return start;
+}
+
+size_t ExtentAllocator::getFragmentedFrames(size_t frames) const
+{
+    // Extents at least as long as the largest request are never counted
+    size_t length = std::min(frames, shortFrames.size());
+    size_t fragmented = 0;
+    for (size_t i = length > 0 ? length - 1 : 0; i > 0; i -= i & (~i + 1))
+    {
+        fragmented += shortFrames[i];
+    }
+    return fragmented;
+}
+
+void ExtentAllocator::insertExtent(size_t start, size_t length)
+{
+    byStart.emplace(start, length);
+    bySize.emplace(length, start);
+    countShortFrames(length, true);
+    freeFrames += length;
+    addFreeRun(length);
+
+    size_t node;
+    if (freeNodes.empty())
+    {
+        node = nodes.size();
+        nodes.emplace_back();
+    }
+    else
+    {
+        node = freeNodes.back();
+        freeNodes.pop_back();
+    }
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    nodes[node] = {start, length, length, seed, npos, npos};
+
+    size_t low, high;
+    split(root, start, low, high);
+    root = merge(merge(low, node), high);
+}
+
+void ExtentAllocator::eraseExtent(size_t start, size_t length)
+{
+    byStart.erase(start);
+    bySize.erase({length, start});
+    countShortFrames(length, false);
+    freeFrames -= length;
+    removeFreeRun(length);
+
+    size_t low, middle, high;
+    split(root, start, low, high);
+    split(high, start + 1, middle, high);
+    if (middle != npos)
+    {
+        freeNodes.push_back(middle);
+    }
+    root = merge(low, high);
+}
+
+void ExtentAllocator::update(size_t node)
+{
+    TreeNode &n = nodes[node];
+    n.longest = n.length;
+    if (n.left != npos)
+        n.longest = std::max(n.longest, nodes[n.left].longest);
+    if (n.right != npos)
+        n.longest = std::max(n.longest, nodes[n.right].longest);
+}
+
+void ExtentAllocator::split(size_t node, size_t start, size_t &low, size_t &high)
+{
+    // low gets the extents that begin before start
+    if (node == npos)
+    {
+        low = high = npos;
+        return;
+    }
+    if (nodes[node].start < start)
+    {
+        split(nodes[node].right, start, nodes[node].right, high);
+        low = node;
+    }
+    else
+    {
+        split(nodes[node].left, start, low, nodes[node].left);
+        high = node;
+    }
+    update(node);
+}
+
+size_t ExtentAllocator::merge(size_t low, size_t high)
+{
+    if (low == npos)
+        return high;
+    if (high == npos)
+        return low;
+
+    if (nodes[low].priority > nodes[high].priority)
+    {
+        nodes[low].right = merge(nodes[low].right, high);
+        update(low);
+        return low;
+    }
+    nodes[high].left = merge(low, nodes[high].left);
+    update(high);
+    return high;
+}
+
+size_t ExtentAllocator::findFit(size_t node, size_t from, size_t frames) const
+{
+    if (node == npos || nodes[node].longest < frames)
+        return npos;
+
+    const TreeNode &n = nodes[node];
+    if (n.start < from)
+        return findFit(n.right, from, frames);
+
+    size_t start = findFit(n.left, from, frames);
+    if (start != npos)
+        return start;
+    if (n.length >= frames)
+        return n.start;
+    return findFit(n.right, from, frames);
+}
+
+void ExtentAllocator::countShortFrames(size_t length, bool add)
+{
+    for (size_t i = length; i > 0 && i < shortFrames.size(); i += i & (~i + 1))
+    {
+        if (add)
+            shortFrames[i] += length;
+        else
+            shortFrames[i] -= length;
+    }
+}
@@ -0,0 +1,103 @@
+#ifndef EXTENT_ALLOCATOR_H
+#define EXTENT_ALLOCATOR_H
+
+#include <map>
+#include <set>
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include "MemoryAllocator.h"
+
+// Free space as a set of maximal runs of free frames (extents), indexed
+// three ways so no operation walks the frame table:
+//   byStart - start -> length, ordered by address, for coalescing on release
+//   bySize  - (length, start), for best fit and the largest free block
+//   tree    - a treap by start whose nodes know the longest extent below
+//             them, so first and next fit skip subtrees too short to hold
+//             the request, whatever its size
+// Allocation and release are O(log n) in the number of extents. Free frames
+// in extents shorter than the largest request are also summed by length in a
+// Fenwick tree, so the fragmentation a request of any size sees costs
+// O(log m) in that size. The free-run histogram is counted as extents come
+// and go, and the largest extent is the last in bySize.
+//
+// allocate() places by the strategy given at construction:
+//   first - lowest address that fits
+//   next  - like first, but searching on from where the last block ended
+//   best  - smallest extent that fits
+//   worst - largest extent
+// Every strategy takes the low end of the chosen extent.
+class ExtentAllocator : public MemoryAllocator
+{
+public:
+    enum Strategy
+    {
+        FIRST_FIT,
+        NEXT_FIT,
+        BEST_FIT,
+        WORST_FIT
+    };
+
+    explicit ExtentAllocator(Strategy strategy = FIRST_FIT) : strategy(strategy) {}
+
+    const char *getName() const override;
+    void reset(size_t totalFrames, size_t maxRequestFrames) override;
+
+    size_t allocate(size_t frames) override;
+    void release(size_t start, size_t frames) override;
+
+    // Return the first frame of the allocated run, or npos
+    size_t allocateFirstFit(size_t frames);
+    size_t allocateNextFit(size_t frames);
+    size_t allocateBestFit(size_t frames);
+    size_t allocateWorstFit(size_t frames);
+
+    size_t getFreeFrames() const override { return freeFrames; }
+    size_t getLargestFree() const override { return bySize.empty() ? 0 : bySize.rbegin()->first; }
+    size_t getFragmentedFrames(size_t frames) const override;
+    size_t getExtentCount() const { return byStart.size(); }
+
+    // For compaction: the lowest free extent as (start, length), (npos, 0) if
+    // none, and claiming an exact range that lies inside one free extent
+    std::pair<size_t, size_t> getLowestExtent() const;
+    bool allocateAt(size_t start, size_t frames);
+
+private:
+    Strategy strategy;
+    size_t rover{0}; // Next fit resumes its search here
+
+    std::map<size_t, size_t> byStart;
+    std::set<std::pair<size_t, size_t>> bySize;
+    size_t freeFrames{0};
+
+    struct TreeNode
+    {
+        size_t start;
+        size_t length;
+        size_t longest; // Longest extent in this subtree
+        uint32_t priority;
+        size_t left;
+        size_t right;
+    };
+    std::vector<TreeNode> nodes;
+    std::vector<size_t> freeNodes;
+    size_t root{npos};
+    uint32_t seed{1};
+
+    // Fenwick tree over extent lengths below the largest request, summing
+    // the free frames in extents of each length
+    std::vector<size_t> shortFrames;
+
+    void insertExtent(size_t start, size_t length);
+    void eraseExtent(size_t start, size_t length);
+    size_t takeFrom(size_t start, size_t length, size_t frames);
+
+    void update(size_t node);
+    void split(size_t node, size_t start, size_t &low, size_t &high);
+    size_t merge(size_t low, size_t high);
+    size_t findFit(size_t node, size_t from, size_t frames) const; // Lowest start >= from
+    void countShortFrames(size_t length, bool add);
+};
+
+#endif
@@ -0,0 +1,191 @@
+#include "FinishedHistory.h"
+#include <algorithm>
+#include <cstring>
+
+ProcessSummary ProcessSummary::of(Process &process)
+{
+    ProcessSummary summary{};
+    summary.pid = process.getPID();
+    summary.linesOfCode = static_cast<uint32_t>(process.getLinesOfCode());
+    summary.arrivalCycle = process.getArrivalCycle();
+    summary.firstRunCycle = process.getFirstRunCycle();
+    summary.finishCycle = process.getFinishCycle();
+    summary.waitingCycles = process.getWaitingCycles();
+    summary.createdAtMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                              process.getCreationTime().time_since_epoch())
+                              .count();
+
+    std::string name = process.getName();
+    std::strncpy(summary.name, name.c_str(), sizeof(summary.name) - 1);
+    return summary;
+}
+
+std::chrono::system_clock::time_point ProcessSummary::getCreationTime() const
+{
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::milliseconds(createdAtMs)));
+}
+
+void FinishedHistory::open(size_t retentionLimit, const std::string &path)
+{
+    stop();
+
+    std::lock_guard<std::mutex> lock(ringMutex);
+    retention = std::max<size_t>(retentionLimit, 1);
+    ring.clear();
+    ring.reserve(retention);
+    oldest = 0;
+    evicted.clear();
+    archived = 0;
+    total = 0;
+
+    archivePath = path;
+    archive.open(archivePath, std::ios::binary | std::ios::trunc);
+
+    stopping = false;
+    writerThread = std::thread(&FinishedHistory::writerLoop, this);
+}
+
+void FinishedHistory::stop()
+{
+    if (!writerThread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(ringMutex);
+        stopping = true;
+    }
+    writerCv.notify_one();
+    writerThread.join();
+    archive.close();
+}
+
+void FinishedHistory::add(const ProcessSummary &summary)
+{
+    std::lock_guard<std::mutex> lock(ringMutex);
+
+    if (ring.size() < retention)
+    {
+        ring.push_back(summary);
+    }
+    else
+    {
+        // Hand the oldest to the writer and reuse its slot
+        evicted.push_back(ring[oldest]);
+        ring[oldest] = summary;
+        oldest = (oldest + 1) % retention;
+        if (evicted.size() == WAKE_QUEUED)
+        {
+            writerCv.notify_one();
+        }
+    }
+    ++total;
+}
+
+void FinishedHistory::writerLoop()
+{
+    std::unique_lock<std::mutex> lock(ringMutex);
+    while (true)
+    {
+        writerCv.wait_for(lock, std::chrono::milliseconds(FLUSH_INTERVAL_MS), [this]
+                          { return stopping || evicted.size() >= WAKE_QUEUED; });
+
+        // Copied rather than taken, so readers still find the batch in
+        // memory until it is on disk
+        std::vector<ProcessSummary> batch(evicted.begin(), evicted.end());
+        bool finished = stopping;
+        lock.unlock();
+
+        if (!batch.empty())
+        {
+            archive.write(reinterpret_cast<const char *>(batch.data()),
+                          static_cast<std::streamsize>(batch.size() * sizeof(ProcessSummary)));
+            archive.flush();
+        }
+
+        lock.lock();
+        evicted.erase(evicted.begin(), evicted.begin() + static_cast<std::ptrdiff_t>(batch.size()));
+        archived += batch.size();
+        if (finished && evicted.empty())
+            return;
+    }
+}
+
+std::vector<ProcessSummary> FinishedHistory::recent() const
+{
+    std::lock_guard<std::mutex> lock(ringMutex);
+
+    std::vector<ProcessSummary> summaries;
+    summaries.reserve(ring.size());
+    for (size_t i = 0; i < ring.size(); ++i)
+    {
+        summaries.push_back(ring[(oldest + i) % ring.size()]);
+    }
+    return summaries;
+}
+
+bool FinishedHistory::contains(const std::string &name) const
+{
+    // Summaries hold names truncated to fit
+    std::string stored = name.substr(0, sizeof(ProcessSummary::name) - 1);
+    auto matches = [&stored](const ProcessSummary &summary)
+    { return stored == summary.name; };
+
+    size_t archivedCount;
+    {
+        std::lock_guard<std::mutex> lock(ringMutex);
+        if (std::any_of(ring.begin(), ring.end(), matches) || std::any_of(evicted.begin(), evicted.end(), matches))
+            return true;
+        archivedCount = archived;
+    }
+
+    const size_t CHUNK = 4096;
+    for (size_t first = 0; first < archivedCount; first += CHUNK)
+    {
+        auto chunk = readArchive(first, std::min(CHUNK, archivedCount - first));
+        if (std::any_of(chunk.begin(), chunk.end(), matches))
+            return true;
+    }
+    return false;
+}
+
+std::vector<ProcessSummary> FinishedHistory::read(size_t first, size_t count) const
+{
+    std::vector<ProcessSummary> fromMemory;
+    size_t archivedCount;
+    {
+        // Only the in-memory part is copied under the lock; archived
+        // records never change, so they are read after releasing it
+        std::lock_guard<std::mutex> lock(ringMutex);
+        archivedCount = archived;
+
+        size_t ringStart = archived + evicted.size();
+        size_t end = std::min(first + count, ringStart + ring.size());
+        for (size_t i = std::max(first, archived); i < end; ++i)
+        {
+            if (i < ringStart)
+                fromMemory.push_back(evicted[i - archived]);
+            else
+                fromMemory.push_back(ring[(oldest + i - ringStart) % ring.size()]);
+        }
+    }
+
+    std::vector<ProcessSummary> summaries;
+    if (first < archivedCount)
+    {
+        summaries = readArchive(first, std::min(count, archivedCount - first));
+    }
+    summaries.insert(summaries.end(), fromMemory.begin(), fromMemory.end());
+    return summaries;
+}
+
+std::vector<ProcessSummary> FinishedHistory::readArchive(size_t first, size_t count) const
+{
+    // Only records the writer has flushed are asked for, so no lock is needed
+    std::vector<ProcessSummary> summaries(count);
+    std::ifstream in(archivePath, std::ios::binary);
+    in.seekg(static_cast<std::streamoff>(first * sizeof(ProcessSummary)));
+    in.read(reinterpret_cast<char *>(summaries.data()), static_cast<std::streamsize>(count * sizeof(ProcessSummary)));
+    summaries.resize(static_cast<size_t>(in.gcount()) / sizeof(ProcessSummary));
+    return summaries;
+}
@@ -0,0 +1,87 @@
+#ifndef FINISHED_HISTORY_H
+#define FINISHED_HISTORY_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <fstream>
+#include <chrono>
+#include <cstdint>
+#include "Process.h"
+
+// Fixed-size record of a finished process. The same layout is kept in
+// memory and written to the archive file, so names are truncated to 63
+// characters.
+struct ProcessSummary
+{
+    int32_t pid;
+    uint32_t linesOfCode;
+    uint64_t arrivalCycle;
+    uint64_t firstRunCycle;
+    uint64_t finishCycle;
+    uint64_t waitingCycles;
+    int64_t createdAtMs; // Creation time, milliseconds since the epoch
+    char name[64];
+
+    static ProcessSummary of(Process &process);
+    std::string getName() const { return name; }
+    std::chrono::system_clock::time_point getCreationTime() const;
+};
+
+// Every finished process in finish order. The newest `retention` summaries
+// stay in memory; older ones are appended to a binary archive file of raw
+// ProcessSummary records. Index 0 is the first process that finished, and
+// read() pages across the archive and memory transparently.
+//
+// add() runs on the finishing core, so it never touches the disk: evicted
+// summaries wait in memory until a writer thread appends them to the
+// archive, once per flush interval or sooner when WAKE_QUEUED are waiting.
+// Readers only read the records the writer has already flushed and take
+// the rest from memory, so a reader never waits on disk I/O it caused.
+class FinishedHistory
+{
+public:
+    static constexpr size_t WAKE_QUEUED = 1024;
+    static constexpr int FLUSH_INTERVAL_MS = 50;
+
+    ~FinishedHistory() { stop(); }
+
+    void open(size_t retention, const std::string &archivePath);
+    void stop(); // Writes out every evicted summary still waiting
+    void add(const ProcessSummary &summary);
+
+    size_t size() const { return total.load(); }
+    std::vector<ProcessSummary> read(size_t first, size_t count) const;
+
+    // The summaries still held in memory, oldest first
+    std::vector<ProcessSummary> recent() const;
+
+    // Whether a process of this name has finished; reads the whole archive
+    // if the name is not among the recent ones
+    bool contains(const std::string &name) const;
+
+private:
+    size_t retention{1};
+    std::vector<ProcessSummary> ring; // ring[(oldest + i) % retention]
+    size_t oldest{0};
+    mutable std::mutex ringMutex;
+    std::atomic<size_t> total{0};
+
+    std::deque<ProcessSummary> evicted; // Out of the ring, not yet on disk
+    size_t archived{0};                 // Flushed to the archive, guarded by ringMutex
+
+    std::string archivePath;
+    std::ofstream archive; // Writer thread only
+    std::thread writerThread;
+    std::condition_variable writerCv; // Waits on ringMutex
+    bool stopping{false};
+
+    void writerLoop();
+    std::vector<ProcessSummary> readArchive(size_t first, size_t count) const;
+};
+
+#endif
@@ -0,0 +1,139 @@
+#include "FrameTable.h"
+#include <algorithm>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+    // Index of the lowest set bit; word must be non-zero
+    unsigned countTrailingZeros(uint64_t word)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return static_cast<unsigned>(index);
+#else
+        return static_cast<unsigned>(__builtin_ctzll(word));
+#endif
+    }
+
+    unsigned countOnes(uint64_t word)
+    {
+#ifdef _MSC_VER
+        return static_cast<unsigned>(__popcnt64(word));
+#else
+        return static_cast<unsigned>(__builtin_popcountll(word));
+#endif
+    }
+}
+
+void FrameTable::reset(size_t frames)
+{
+    frameCount = frames;
+    occupied.assign((frames + 63) / 64, 0);
+    owners.assign(frames, 0);
+
+    // Bits past the last frame stay set so searches never hand them out
+    if (frames % 64 != 0)
+    {
+        occupied.back() = ~uint64_t{0} << (frames % 64);
+    }
+}
+
+void FrameTable::assign(size_t start, size_t count, uint32_t pid)
+{
+    setBits(start, count, true);
+    std::fill(owners.begin() + start, owners.begin() + start + count, pid);
+}
+
+void FrameTable::clear(size_t start, size_t count)
+{
+    setBits(start, count, false);
+    std::fill(owners.begin() + start, owners.begin() + start + count, 0);
+}
+
+void FrameTable::setBits(size_t start, size_t count, bool value)
+{
+    size_t end = start + count;
+    while (start < end)
+    {
+        size_t bit = start % 64;
+        size_t span = std::min<size_t>(64 - bit, end - start);
+        uint64_t mask = span == 64 ? ~uint64_t{0} : ((uint64_t{1} << span) - 1) << bit;
+
+        if (value)
+            occupied[start / 64] |= mask;
+        else
+            occupied[start / 64] &= ~mask;
+        start += span;
+    }
+}
+
+size_t FrameTable::countFree() const
+{
+    size_t used = 0;
+    for (uint64_t word : occupied)
+    {
+        used += countOnes(word);
+    }
+    return occupied.size() * 64 - used;
+}
+
+size_t FrameTable::findFreeRun(size_t count, size_t from) const
+{
+    if (count == 0 || from >= frameCount)
+        return npos;
+
+    size_t runStart = from;
+    size_t runLength = 0;
+
+    for (size_t index = from / 64; index < occupied.size(); ++index)
+    {
+        uint64_t word = occupied[index];
+        unsigned bit = 0;
+        if (index == from / 64)
+        {
+            // Treat frames before `from` as used
+            bit = from % 64;
+            word |= (uint64_t{1} << bit) - 1;
+        }
+
+        if (word == 0)
+        {
+            runLength += 64;
+            if (runLength >= count)
+                return runStart;
+            continue;
+        }
+        if (word == ~uint64_t{0})
+        {
+            runLength = 0;
+            runStart = (index + 1) * 64;
+            continue;
+        }
+
+        // Mixed word: hop from one run of equal bits to the next
+        while (bit < 64)
+        {
+            uint64_t rest = word >> bit;
+            if ((rest & 1) == 0)
+            {
+                unsigned freeBits = rest == 0 ? 64 - bit : countTrailingZeros(rest);
+                runLength += freeBits;
+                if (runLength >= count)
+                    return runStart;
+                bit += freeBits;
+            }
+            else
+            {
+                uint64_t inverted = ~rest;
+                unsigned usedBits = inverted == 0 ? 64 - bit : countTrailingZeros(inverted);
+                bit += usedBits;
+                runLength = 0;
+                runStart = index * 64 + bit;
+            }
+        }
+    }
+    return npos;
+}
@@ -0,0 +1,42 @@
+#ifndef FRAME_TABLE_H
+#define FRAME_TABLE_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Per-frame state in about 4 bytes a frame: one occupancy bit, packed 64 to
+// a word, plus the owning PID (0 when free). Addresses are not stored since
+// frame * frameSize gives them. Marking and clearing runs works a word at a
+// time, and free-run searches skip full words and jump over runs of equal
+// bits with count-trailing-zeros instead of testing frames one by one.
+class FrameTable
+{
+public:
+    static constexpr size_t npos = SIZE_MAX;
+
+    void reset(size_t frames);
+
+    void assign(size_t start, size_t count, uint32_t pid);
+    void clear(size_t start, size_t count);
+
+    bool isFree(size_t frame) const { return (occupied[frame / 64] >> (frame % 64) & 1) == 0; }
+    uint32_t getOwner(size_t frame) const { return owners[frame]; }
+    size_t size() const { return frameCount; }
+    size_t countFree() const;
+
+    // Lowest start >= from of count consecutive free frames, or npos
+    size_t findFreeRun(size_t count, size_t from = 0) const;
+
+    // Bytes used by the table itself
+    size_t getFootprint() const { return occupied.capacity() * sizeof(uint64_t) + owners.capacity() * sizeof(uint32_t); }
+
+private:
+    std::vector<uint64_t> occupied; // Bit set = frame in use
+    std::vector<uint32_t> owners;
+    size_t frameCount{0};
+
+    void setBits(size_t start, size_t count, bool value);
+};
+
+#endif
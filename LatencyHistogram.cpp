@@ -0,0 +1,99 @@
+#include "LatencyHistogram.h"
+#include <algorithm>
+
+namespace
+{
+    int highestBit(uint64_t value)
+    {
+        int bit = 0;
+        for (int shift = 32; shift > 0; shift /= 2)
+        {
+            if (value >> shift)
+            {
+                value >>= shift;
+                bit += shift;
+            }
+        }
+        return bit;
+    }
+}
+
+size_t LatencyHistogram::bucketIndex(uint64_t value)
+{
+    if (value < LINEAR_LIMIT)
+        return static_cast<size_t>(value);
+
+    // Keep the top SUB_BUCKET_BITS + 1 bits: value >> shift lands in [32, 64)
+    int shift = highestBit(value) - SUB_BUCKET_BITS;
+    uint64_t top = value >> shift;
+    return static_cast<size_t>(LINEAR_LIMIT + (shift - 1) * SUB_BUCKETS + (top - SUB_BUCKETS));
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t index)
+{
+    if (index < LINEAR_LIMIT)
+        return index;
+
+    int shift = static_cast<int>((index - LINEAR_LIMIT) / SUB_BUCKETS) + 1;
+    uint64_t top = (index - LINEAR_LIMIT) % SUB_BUCKETS + SUB_BUCKETS;
+    return ((top + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value)
+{
+    buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t seen = max.load(std::memory_order_relaxed);
+    while (value > seen && !max.compare_exchange_weak(seen, value, std::memory_order_relaxed))
+    {
+    }
+
+    // Counted last so a reader never sees more samples than bucket entries
+    count.fetch_add(1, std::memory_order_release);
+}
+
+void LatencyHistogram::reset()
+{
+    for (auto &bucket : buckets)
+    {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    total.store(0, std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+    count.store(0, std::memory_order_release);
+}
+
+uint64_t LatencyHistogram::valueAtPercentile(double percent) const
+{
+    uint64_t samples = count.load(std::memory_order_acquire);
+    if (samples == 0)
+        return 0;
+
+    uint64_t rank = static_cast<uint64_t>(percent / 100.0 * samples + 0.5);
+    rank = std::min(std::max<uint64_t>(rank, 1), samples);
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i)
+    {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank)
+            return std::min(bucketUpperBound(i), getMax());
+    }
+    return getMax();
+}
+
+LatencyHistogram::Summary LatencyHistogram::summarize() const
+{
+    Summary summary;
+    summary.count = count.load(std::memory_order_acquire);
+    if (summary.count == 0)
+        return summary;
+
+    summary.mean = total.load(std::memory_order_relaxed) / summary.count;
+    summary.p50 = valueAtPercentile(50);
+    summary.p90 = valueAtPercentile(90);
+    summary.p99 = valueAtPercentile(99);
+    summary.max = getMax();
+    return summary;
+}
@@ -0,0 +1,55 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Log-linear histogram in the style of HdrHistogram, mostly of cycle counts
+// but also of swap and allocation latencies and fragmentation bytes. Values
+// below 64 get a bucket each; above that every power of two is split into 32
+// sub-buckets, so any reported value is within about 3% of the real one.
+// record() is a handful of relaxed atomic adds and never blocks, so cores can
+// call it while finishing processes; readers may see a record half applied,
+// which only skews a live report by that one sample.
+class LatencyHistogram
+{
+public:
+    struct Summary
+    {
+        uint64_t count{0};
+        uint64_t mean{0};
+        uint64_t p50{0};
+        uint64_t p90{0};
+        uint64_t p99{0};
+        uint64_t max{0};
+    };
+
+    void record(uint64_t value);
+    void reset();
+
+    uint64_t getCount() const { return count.load(std::memory_order_relaxed); }
+    uint64_t getMax() const { return max.load(std::memory_order_relaxed); }
+
+    // Smallest value v such that at least percent% of the samples are <= v,
+    // rounded up to the end of v's bucket and capped at the recorded max
+    uint64_t valueAtPercentile(double percent) const;
+    Summary summarize() const;
+
+private:
+    static constexpr int SUB_BUCKET_BITS = 5;
+    static constexpr uint64_t SUB_BUCKETS = uint64_t{1} << SUB_BUCKET_BITS;
+    static constexpr uint64_t LINEAR_LIMIT = SUB_BUCKETS * 2;
+    static constexpr size_t BUCKET_COUNT = LINEAR_LIMIT + (64 - SUB_BUCKET_BITS - 1) * SUB_BUCKETS;
+
+    static size_t bucketIndex(uint64_t value);
+    static uint64_t bucketUpperBound(size_t index);
+
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets{};
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> max{0};
+};
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef MEMORY_ALLOCATOR_H
+#define MEMORY_ALLOCATOR_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Placement of contiguous blocks in flat mode, picked by placement in
+// config.txt. Works in frames; MemoryManager owns the lock and the frame
+// table and records who got which block.
+class MemoryAllocator
+{
+public:
+    static constexpr size_t npos = SIZE_MAX;
+
+    virtual ~MemoryAllocator() = default;
+
+    virtual const char *getName() const = 0;
+
+    // All frames free; no request will be larger than maxRequestFrames
+    virtual void reset(size_t totalFrames, size_t maxRequestFrames) = 0;
+
+    // First frame of a run of at least frames frames, or npos. release takes
+    // the same start and either the count that allocate was called with or
+    // the block size getBlockFrames gives for it.
+    virtual size_t allocate(size_t frames) = 0;
+    virtual void release(size_t start, size_t frames) = 0;
+
+    // Frames a request for frames frames actually holds, rounding included
+    virtual size_t getBlockFrames(size_t frames) const { return frames; }
+
+    virtual size_t getFreeFrames() const = 0;
+    virtual size_t getLargestFree() const = 0;
+
+    // Free frames in blocks too small for a request of frames frames
+    virtual size_t getFragmentedFrames(size_t frames) const = 0;
+
+    bool canFit(size_t frames) const { return getLargestFree() >= frames; }
+
+    // Free runs by size class, bucket k counting runs of [2^k, 2^(k+1))
+    // frames. Kept up to date as runs are split and merged, so reading it
+    // costs nothing however large memory is.
+    static constexpr size_t SIZE_CLASSES = 64;
+    using FreeRunHistogram = std::array<size_t, SIZE_CLASSES>;
+    const FreeRunHistogram &getFreeRuns() const { return freeRuns; }
+    size_t getFreeRunCount() const { return freeRunCount; }
+
+    static size_t sizeClass(size_t frames)
+    {
+        size_t sizeClass = 0;
+        while (frames >>= 1)
+        {
+            ++sizeClass;
+        }
+        return sizeClass;
+    }
+
+protected:
+    void clearFreeRuns()
+    {
+        freeRuns.fill(0);
+        freeRunCount = 0;
+    }
+    void addFreeRun(size_t frames)
+    {
+        ++freeRuns[sizeClass(frames)];
+        ++freeRunCount;
+    }
+    void removeFreeRun(size_t frames)
+    {
+        --freeRuns[sizeClass(frames)];
+        --freeRunCount;
+    }
+
+private:
+    FreeRunHistogram freeRuns{};
+    size_t freeRunCount{0};
+};
+
+#endif
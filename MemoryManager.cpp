@@ -1,23 +1,64 @@
 #include "MemoryManager.h"
-#include <fstream>
+#include "BuddyAllocator.h"
 #include <sstream>
 #include <iomanip>
-#include "Utils.h"
 #include "Config.h"
 #include "Scheduler.h"
 #include <iostream>
-#include <direct.h>
 #include <algorithm>
+#include <chrono>
 
 MemoryManager::MemoryManager()
 {
     const auto &config = Config::getInstance();
     totalFrames = config.getMaxOverallMem() / config.getMemPerFrame();
-    frames.resize(totalFrames);
     frameSize = config.getMemPerFrame();
     processSize = config.getMemPerProc();
     framesPerProcess = processSize / frameSize;
-    updateFragmentation();
+    paging = config.isPagingEnabled();
+    frameTable.reset(totalFrames);
+
+    const std::string &placement = config.getPlacement();
+    if (placement == "buddy")
+    {
+        allocator = std::make_unique<BuddyAllocator>();
+    }
+    else
+    {
+        ExtentAllocator::Strategy strategy = ExtentAllocator::FIRST_FIT;
+        if (placement == "next")
+            strategy = ExtentAllocator::NEXT_FIT;
+        else if (placement == "best")
+            strategy = ExtentAllocator::BEST_FIT;
+        else if (placement == "worst")
+            strategy = ExtentAllocator::WORST_FIT;
+        auto extentAllocator = std::make_unique<ExtentAllocator>(strategy);
+        extents = extentAllocator.get();
+        allocator = std::move(extentAllocator);
+    }
+    allocator->reset(totalFrames, (config.getMaxMemPerProc() + frameSize - 1) / frameSize);
+    lastRequestFrames = framesPerProcess;
+    compactionFrames = config.getCompactionFrames();
+
+    if (paging)
+    {
+        framePages.assign(totalFrames, PageTable::NOT_PRESENT);
+
+        PageReplacement::Policy policy = PageReplacement::FIFO;
+        PageReplacement::parsePolicy(config.getPageReplacement(), policy);
+        replacement.reset(totalFrames, policy);
+    }
+
+    // Without a swap file, or if it cannot be mapped, evicted pages are
+    // dropped and fault back in zero-filled
+    if (paging && !config.getSwapFile().empty())
+    {
+        swapping = backingStore.open(config.getSwapFile(), config.getSwapSize() / frameSize, frameSize);
+    }
+    if (swapping)
+    {
+        physicalMemory.assign(totalFrames * frameSize, 0);
+    }
 }
 
 bool MemoryManager::allocateMemory(std::shared_ptr<Process> process)
@@ -25,151 +66,583 @@ bool MemoryManager::allocateMemory(std::shared_ptr<Process> process)
     if (!process)
         return false;
 
-    if (!memoryMutex.try_lock_for(std::chrono::milliseconds(100)))
+    // Paging mode has nothing to place up front; pages fault in as they are touched
+    if (paging)
+        return true;
+
+    // A timed-out lock would look like an out-of-memory failure and park the
+    // process with nothing to wake it, so wait for the lock
+    std::lock_guard<std::timed_mutex> lock(memoryMutex);
+
+    // Already resident, don't leak a second block
+    if (processMemoryMap.count(process->getName()) > 0)
     {
-        return false;
+        return true;
     }
 
-    std::lock_guard<std::timed_mutex> lock(memoryMutex, std::adopt_lock);
+    // Fragmentation is sampled as each request sees it, for the benchmark
+    size_t frames = (process->getMemorySize() + frameSize - 1) / frameSize;
+    externalFragmentationSamples.record(allocator->getFragmentedFrames(frames) * frameSize);
+    lastRequestFrames = frames;
+    ++allocationAttempts;
 
-    size_t startFrame = findFirstFit();
+    auto placementStart = std::chrono::steady_clock::now();
+    size_t startFrame = allocator->allocate(frames);
+    allocationLatency.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                       std::chrono::steady_clock::now() - placementStart)
+                                                       .count()));
 
-    if (startFrame == frames.size())
+    if (startFrame == MemoryAllocator::npos)
     {
-        if (Config::getInstance().getSchedulerType() == "rr")
-        {
-            process->setState(Process::READY);
-            Scheduler::getInstance().addProcess(process);
-        }
+        // The caller decides where the process waits; queueing it here as
+        // well would leave it in the ready queues twice
+        ++allocationFailures;
+        startCompaction(frames);
         return false;
     }
 
-    // Allocate frames and track memory info
+    // Track the block as handed out, so a rounded-up request shows its full size
+    size_t blockFrames = allocator->getBlockFrames(frames);
     ProcessMemoryInfo memInfo;
     memInfo.startFrame = startFrame;
-    memInfo.numFrames = framesPerProcess;
+    memInfo.numFrames = blockFrames;
+    memInfo.requestedFrames = frames;
     memInfo.startAddress = startFrame * frameSize;
-    memInfo.endAddress = (startFrame + framesPerProcess) * frameSize - 1;
-
-    for (size_t i = startFrame; i < startFrame + framesPerProcess; i++)
-    {
-        frames[i].isFree = false;
-        frames[i].processName = process->getName();
-        frames[i].startAddress = i * frameSize;
-        frames[i].endAddress = (i + 1) * frameSize - 1;
-    }
+    memInfo.endAddress = (startFrame + blockFrames) * frameSize - 1;
 
+    frameTable.assign(startFrame, blockFrames, static_cast<uint32_t>(process->getPID()));
     processMemoryMap[process->getName()] = memInfo;
-    processesInMemory.insert(process->getName());
-    updateFragmentation();
+    usedFrames += blockFrames;
+    roundingFrames += blockFrames - frames;
+    layoutImage.reset();
     return true;
 }
 
-void MemoryManager::generateMemorySnapshot(uint32_t quantumCycle)
+void MemoryManager::requestCompaction(size_t bytes)
 {
     std::lock_guard<std::timed_mutex> lock(memoryMutex);
+    startCompaction((bytes + frameSize - 1) / frameSize);
+}
 
-    _mkdir("memory_stamps");
+void MemoryManager::startCompaction(size_t frames)
+{
+    // Only worth it when the frames are free but scattered
+    if (!extents || compactionFrames == 0 || extents->getFreeFrames() < frames || extents->canFit(frames))
+        return;
 
-    std::stringstream filename;
-    filename << "memory_stamps/memory_stamp_" << std::setw(2) << std::setfill('0')
-             << quantumCycle << ".txt";
+    if (compacting)
+    {
+        compactionTarget = std::max(compactionTarget, frames);
+        return;
+    }
+    compactionTarget = frames;
+    runStartBlocks = blocksMoved.load();
+    compacting = true;
+    ++compactionRuns;
+}
+
+bool MemoryManager::compactStep(uint64_t cycles)
+{
+    auto stepStart = std::chrono::steady_clock::now();
+    bool madeRoom = false;
+    {
+        std::lock_guard<std::timed_mutex> lock(memoryMutex);
+        if (!compacting)
+            return false;
+
+        size_t budget = compactionFrames * cycles;
+        while (compacting)
+        {
+            if (!moving)
+            {
+                if (extents->canFit(compactionTarget))
+                {
+                    // Room made by a release in between has already woken a waiter
+                    madeRoom = blocksMoved.load() != runStartBlocks;
+                    if (madeRoom)
+                    {
+                        ++failuresAvoided;
+                        ++releaseCount;
+                    }
+                    compacting = false;
+                    break;
+                }
+                if (!beginMove())
+                {
+                    // Free space is in one piece at the top and still too small
+                    compacting = false;
+                    break;
+                }
+            }
+            if (budget == 0)
+                break;
+
+            size_t copied = std::min(budget, move.frames - move.copied);
+            move.copied += copied;
+            budget -= copied;
+            if (move.copied == move.frames)
+            {
+                finishMove();
+            }
+        }
+    }
+
+    uint64_t elapsed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                 std::chrono::steady_clock::now() - stepStart)
+                                                 .count());
+    compactionLatency.record(elapsed);
+    compactionTime += elapsed;
+    return madeRoom;
+}
+
+bool MemoryManager::beginMove()
+{
+    // Slide the block right above the lowest hole down to the hole's start
+    auto hole = extents->getLowestExtent();
+    if (hole.first == MemoryAllocator::npos || hole.first + hole.second >= totalFrames)
+        return false;
+
+    size_t blockStart = hole.first + hole.second;
+    auto block = std::find_if(processMemoryMap.begin(), processMemoryMap.end(),
+                              [blockStart](const auto &pair)
+                              { return pair.second.startFrame == blockStart; });
+    if (block == processMemoryMap.end())
+        return false;
+
+    // The free part of the destination is claimed now so nothing else is
+    // placed there while the frames are copied
+    size_t frames = block->second.numFrames;
+    extents->allocateAt(hole.first, std::min(hole.second, frames));
+    move = {block->first, blockStart, hole.first, frames, 0};
+    moving = true;
+    return true;
+}
 
-    std::ofstream file(filename.str());
-    if (!file)
+void MemoryManager::finishMove()
+{
+    moving = false;
+    auto block = processMemoryMap.find(move.process);
+    if (block == processMemoryMap.end())
         return;
 
-    auto stats = getMemoryStatistics();
+    uint32_t owner = frameTable.getOwner(move.from);
+    frameTable.clear(move.from, move.frames);
+    frameTable.assign(move.to, move.frames, owner);
+
+    // Source frames the block no longer covers join the hole above it
+    size_t freedStart = std::max(move.from, move.to + move.frames);
+    extents->release(freedStart, move.from + move.frames - freedStart);
+
+    ProcessMemoryInfo &info = block->second;
+    info.startFrame = move.to;
+    info.startAddress = move.to * frameSize;
+    info.endAddress = (move.to + move.frames) * frameSize - 1;
+    ++blocksMoved;
+    framesMoved += move.frames;
+    layoutImage.reset();
+}
 
-    file << "Timestamp: " << getCurrentTimestamp() << "\n";
-    file << "Number of processes in memory: " << stats.processCount << "\n";
-    file << "Total external fragmentation in KB: "
-         << stats.externalFragmentation / 1024 << "\n\n";
+void MemoryManager::generateMemorySnapshot(uint32_t quantumCycle)
+{
+    if (!snapshotWriter.isRunning())
+        return;
+
+    // Only the capture happens under the lock; formatting and file I/O are
+    // left to the writer thread
+    auto captureStart = std::chrono::steady_clock::now();
+    MemorySnapshot snapshot{};
+    {
+        std::lock_guard<std::timed_mutex> lock(memoryMutex);
+        if (!layoutImage)
+        {
+            layoutImage = paging ? buildFrameLayout() : buildLayout();
+        }
+
+        auto stats = getMemoryStatisticsLocked();
+        snapshot.layout = layoutImage;
+        snapshot.header.timestamp = static_cast<int64_t>(std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()));
+        snapshot.header.totalMemory = totalFrames * frameSize;
+        snapshot.header.externalFragmentation = stats.externalFragmentation;
+        snapshot.header.cycle = quantumCycle;
+        snapshot.header.processCount = static_cast<uint32_t>(stats.processCount);
+        snapshot.header.blockCount = static_cast<uint32_t>(layoutImage->blocks.size());
+        snapshot.header.namesSize = static_cast<uint32_t>(layoutImage->names.size());
+    }
+    snapshotCaptureLatency.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                            std::chrono::steady_clock::now() - captureStart)
+                                                            .count()));
+
+    snapshotWriter.submit(std::move(snapshot));
+}
+
+void MemoryManager::startSnapshotLog()
+{
+    const auto &config = Config::getInstance();
+    if (!config.areMemorySnapshotsEnabled() || snapshotWriter.isRunning())
+        return;
 
-    printMemoryMap(file);
+    // The first start of a run begins a new log, restarts append to it
+    if (!snapshotWriter.start(config.getSnapshotLog(), !snapshotLogStarted))
+    {
+        std::cerr << "Could not open snapshot log " << config.getSnapshotLog() << ", memory snapshots disabled\n";
+        return;
+    }
+    snapshotLogStarted = true;
 }
 
-void MemoryManager::printMemoryMap(std::ofstream &file) const
+void MemoryManager::stopSnapshotLog()
 {
-    size_t totalMem = Config::getInstance().getMaxOverallMem();
+    snapshotWriter.stop();
+}
 
-    file << "----end---- = " << totalMem << "\n\n";
+std::shared_ptr<const MemoryLayout> MemoryManager::buildLayout() const
+{
+    auto layout = std::make_shared<MemoryLayout>();
 
-    // Sort processes by memory address for proper display
-    std::vector<std::pair<size_t, const ProcessMemoryInfo *>> sortedProcesses;
+    // Highest address first, as the memory stamps list them
+    std::vector<std::pair<const std::string *, const ProcessMemoryInfo *>> sortedProcesses;
     for (const auto &pair : processMemoryMap)
     {
-        sortedProcesses.push_back({pair.second.startAddress, &pair.second});
+        sortedProcesses.push_back({&pair.first, &pair.second});
     }
     std::sort(sortedProcesses.begin(), sortedProcesses.end(),
-              std::greater<std::pair<size_t, const ProcessMemoryInfo *>>());
+              [](const auto &a, const auto &b)
+              { return a.second->startAddress > b.second->startAddress; });
 
-    // Print each process's memory boundaries
     for (const auto &pair : sortedProcesses)
     {
-        const ProcessMemoryInfo *info = pair.second;
-        file << info->endAddress + 1 << "\n";
+        layout->blocks.push_back({pair.second->startAddress, pair.second->endAddress + 1,
+                                  static_cast<uint32_t>(layout->names.size()), static_cast<uint32_t>(pair.first->size())});
+        layout->names += *pair.first;
+    }
+    return layout;
+}
+
+std::shared_ptr<const MemoryLayout> MemoryManager::buildFrameLayout() const
+{
+    auto layout = std::make_shared<MemoryLayout>();
 
-        // Find process name
-        std::string processName;
-        for (size_t i = info->startFrame; i < info->startFrame + info->numFrames; i++)
+    // One block per run of frames with the same owner
+    size_t end = totalFrames;
+    while (end > 0)
+    {
+        uint32_t owner = frameTable.getOwner(end - 1);
+        size_t start = end - 1;
+        while (start > 0 && frameTable.getOwner(start - 1) == owner)
         {
-            if (!frames[i].processName.empty())
-            {
-                processName = frames[i].processName;
-                break;
-            }
+            --start;
         }
-        file << processName << "\n";
-        file << info->startAddress << "\n\n";
+
+        if (owner != 0)
+        {
+            auto resident = residentProcesses.find(static_cast<int>(owner));
+            auto process = resident != residentProcesses.end() ? resident->second.lock() : nullptr;
+            std::string name = process ? process->getName() : "pid " + std::to_string(owner);
+            layout->blocks.push_back({start * frameSize, end * frameSize,
+                                      static_cast<uint32_t>(layout->names.size()), static_cast<uint32_t>(name.size())});
+            layout->names += name;
+        }
+        end = start;
+    }
+    return layout;
+}
+
+MemoryManager::FaultResult MemoryManager::handlePageFault(const std::shared_ptr<Process> &process, uint32_t page, PageRequest &request)
+{
+    std::lock_guard<std::timed_mutex> lock(memoryMutex);
+
+    PageTable &pageTable = process->getPageTable();
+    if (pageTable.isPresent(page))
+        return MAPPED;
+
+    // Free frames are handed out round-robin from a moving hint so a fault
+    // does not rescan the frames it just filled
+    size_t frame = frameTable.findFreeRun(1, nextFrameHint);
+    if (frame == FrameTable::npos)
+    {
+        frame = frameTable.findFreeRun(1, 0);
+    }
+
+    uint32_t writeSlot = PageTable::NO_SLOT;
+    if (frame != FrameTable::npos)
+    {
+        nextFrameHint = frame + 1 < totalFrames ? frame + 1 : 0;
+        ++usedFrames;
+    }
+    else
+    {
+        frame = evictFrame(writeSlot);
+    }
+
+    // Only when every frame is mid-swap
+    if (frame == FrameTable::npos)
+    {
+        ++allocationFailures;
+        return NO_MEMORY;
+    }
+
+    frameTable.assign(frame, 1, static_cast<uint32_t>(process->getPID()));
+    layoutImage.reset();
+    pageTable.countFault();
+    ++pageFaults;
+    residentProcesses[process->getPID()] = process;
+
+    uint32_t readSlot = pageTable.getSwapSlot(page);
+    if (writeSlot == PageTable::NO_SLOT && readSlot == PageTable::NO_SLOT)
+    {
+        if (swapping)
+        {
+            std::fill_n(&physicalMemory[frame * frameSize], frameSize, 0);
+        }
+        pageTable.map(page, static_cast<uint32_t>(frame));
+        framePages[frame] = page;
+        replacement.onLoad(frame, true);
+        return MAPPED;
     }
 
-    file << "----start---- = 0\n";
+    // The frame stays owned but unmapped, which also keeps evictFrame off it,
+    // until the pager has moved the data
+    framePages[frame] = PageTable::NOT_PRESENT;
+    request = {process, page, static_cast<uint32_t>(frame), writeSlot, readSlot, std::chrono::steady_clock::now(), pager.reserveSequence()};
+    return SWAPPING;
 }
 
-size_t MemoryManager::getExternalFragmentation() const
+size_t MemoryManager::evictFrame(uint32_t &writeSlot)
 {
-    std::lock_guard<std::timed_mutex> lock(memoryMutex, std::adopt_lock);
-    size_t fragmentation = 0;
-    size_t consecutiveFree = 0;
+    size_t frame = replacement.selectVictim(framePages);
+    if (frame == PageReplacement::npos)
+        return FrameTable::npos;
+
+    auto owner = residentProcesses.find(static_cast<int>(frameTable.getOwner(frame)));
+    auto victim = owner != residentProcesses.end() ? owner->second.lock() : nullptr;
+    if (!victim)
+        return FrameTable::npos;
+
+    // A core running the victim sees the page gone and faults it back in
+    PageTable &victimTable = victim->getPageTable();
+    uint32_t victimPage = framePages[frame];
+    victimTable.unmap(victimPage);
+    framePages[frame] = PageTable::NOT_PRESENT;
+    ++evictions;
+
+    if (!swapping)
+        return frame;
+
+    // A clean page still has a current copy in its slot. A dirty one is
+    // written back, or dropped if the swap file is full.
+    uint32_t slot = victimTable.getSwapSlot(victimPage);
+    if (slot != PageTable::NO_SLOT && !replacement.isDirty(frame))
+        return frame;
+
+    if (slot == PageTable::NO_SLOT)
+    {
+        slot = backingStore.allocateSlot();
+        victimTable.setSwapSlot(victimPage, slot);
+    }
+    writeSlot = slot;
+    return frame;
+}
+
+void MemoryManager::submitPageRequest(PageRequest request)
+{
+    pager.submit(std::move(request));
+}
 
-    for (size_t i = 0; i < frames.size(); i++)
+void MemoryManager::completePageRequests(std::vector<PageRequest> &batch)
+{
+    bool wrote = false;
+    for (const auto &request : batch)
     {
-        if (frames[i].isFree)
+        char *data = &physicalMemory[static_cast<size_t>(request.frame) * frameSize];
+        if (request.writeSlot != PageTable::NO_SLOT)
         {
-            consecutiveFree++;
+            backingStore.write(request.writeSlot, data);
+            ++pagesOut;
+            wrote = true;
         }
-        else if (consecutiveFree > 0)
+
+        if (request.readSlot != PageTable::NO_SLOT)
         {
-            if (consecutiveFree < framesPerProcess)
-            {
-                fragmentation += consecutiveFree * frameSize;
-            }
-            consecutiveFree = 0;
+            backingStore.read(request.readSlot, data);
+            ++pagesIn;
+        }
+        else
+        {
+            std::fill_n(data, frameSize, 0);
+        }
+    }
+
+    // One writeback for the whole batch
+    if (wrote)
+    {
+        backingStore.flush();
+    }
+
+    {
+        std::lock_guard<std::timed_mutex> lock(memoryMutex);
+        for (const auto &request : batch)
+        {
+            // A page read back keeps its slot, so it stays clean until written
+            request.process->getPageTable().map(request.page, request.frame);
+            framePages[request.frame] = request.page;
+            replacement.onLoad(request.frame, request.readSlot == PageTable::NO_SLOT);
         }
     }
 
-    if (consecutiveFree > 0 && consecutiveFree < framesPerProcess)
+    auto now = std::chrono::steady_clock::now();
+    for (auto &request : batch)
+    {
+        swapLatency.record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(now - request.submitted).count()));
+        Scheduler::getInstance().resumeAfterPageIn(std::move(request.process));
+    }
+}
+
+void MemoryManager::startPager()
+{
+    if (swapping && !pager.isRunning())
+    {
+        pager.start([this](std::vector<PageRequest> &batch)
+                    { completePageRequests(batch); });
+    }
+}
+
+void MemoryManager::stopPager()
+{
+    pager.stop();
+}
+
+void MemoryManager::printVirtualMemoryStats() const
+{
+    // Flat mode has no pages, so show placement and free space instead
+    if (!paging)
+    {
+        std::cout << "Memory mode: flat\n";
+        printMemoryUsage();
+        return;
+    }
+
+    std::lock_guard<std::timed_mutex> lock(memoryMutex);
+
+    std::stringstream report;
+    report << "Memory mode: paging\n";
+
+    report << "Frames: " << usedFrames << " / " << totalFrames << " used ("
+           << (totalFrames > 0 ? usedFrames * 100 / totalFrames : 0) << "% utilization)\n";
+    writePagingStatistics(report, getMemoryStatisticsLocked());
+    report << "Allocation failures: " << allocationFailures.load() << "\n";
+    if (swapping)
+    {
+        auto latency = swapLatency.summarize();
+        report << "Swap: " << (backingStore.getSlotCount() - backingStore.getFreeSlots()) << " / "
+               << backingStore.getSlotCount() << " slots used, "
+               << pagesIn.load() << " pages in, " << pagesOut.load() << " pages out\n";
+        report << "Swap latency (us): mean " << latency.mean << ", p50 " << latency.p50
+               << ", p99 " << latency.p99 << ", max " << latency.max << "\n";
+    }
+    report << "\n";
+
+    report << std::left << std::setw(12) << "Process" << std::right
+           << std::setw(10) << "Resident" << std::setw(10) << "Pages"
+           << std::setw(10) << "RSS KB" << std::setw(10) << "Faults" << "\n";
+    for (const auto &pair : residentProcesses)
     {
-        fragmentation += consecutiveFree * frameSize;
+        auto process = pair.second.lock();
+        if (!process)
+            continue;
+
+        const PageTable &pageTable = process->getPageTable();
+        report << std::left << std::setw(12) << process->getName() << std::right
+               << std::setw(10) << pageTable.getResidentPages()
+               << std::setw(10) << pageTable.size()
+               << std::setw(10) << pageTable.getResidentPages() * frameSize / 1024
+               << std::setw(10) << pageTable.getPageFaults() << "\n";
     }
 
-    return fragmentation;
+    std::cout << report.str();
+}
+
+size_t MemoryManager::getExternalFragmentation() const
+{
+    std::lock_guard<std::timed_mutex> lock(memoryMutex);
+    return paging ? 0 : allocator->getFragmentedFrames(lastRequestFrames) * frameSize;
 }
 
 MemoryStatistics MemoryManager::getMemoryStatistics() const
 {
-    std::lock_guard<std::timed_mutex> lock(memoryMutex, std::adopt_lock);
-    MemoryStatistics stats;
+    std::lock_guard<std::timed_mutex> lock(memoryMutex);
+    return getMemoryStatisticsLocked();
+}
+
+MemoryStatistics MemoryManager::getMemoryStatisticsLocked() const
+{
+    MemoryStatistics stats{};
     stats.totalMemory = Config::getInstance().getMaxOverallMem();
-    stats.usedMemory = processMemoryMap.size() * processSize;
-    stats.processCount = processMemoryMap.size();
+    if (paging)
+    {
+        // Any free frame can back any page, so nothing is lost to fragmentation
+        stats.usedMemory = usedFrames * frameSize;
+        stats.processCount = residentProcesses.size();
+        stats.externalFragmentation = 0;
+        stats.largestFreeBlock = (totalFrames - usedFrames) > 0 ? frameSize : 0;
+
+        // Every executed instruction makes exactly one page reference
+        stats.pageReferences = retiredReferences;
+        for (const auto &pair : residentProcesses)
+        {
+            if (auto process = pair.second.lock())
+            {
+                stats.pageReferences += process->getCommandCounter();
+            }
+        }
+        stats.pageFaults = pageFaults.load();
+        stats.evictions = evictions.load();
+        stats.writebacks = pagesOut.load();
+    }
+    else
+    {
+        stats.usedMemory = usedFrames * frameSize;
+        stats.processCount = processMemoryMap.size();
+        stats.externalFragmentation = allocator->getFragmentedFrames(lastRequestFrames) * frameSize;
+        stats.internalFragmentation = roundingFrames * frameSize;
+        stats.largestFreeBlock = allocator->getLargestFree() * frameSize;
+        stats.freeRuns = allocator->getFreeRunCount();
+    }
     stats.freeMemory = stats.totalMemory - stats.usedMemory;
-    stats.externalFragmentation = getExternalFragmentation();
 
     return stats;
 }
 
+uint32_t MemoryManager::getFrameOwner(size_t frame) const
+{
+    std::lock_guard<std::timed_mutex> lock(memoryMutex);
+    return frame < frameTable.size() ? frameTable.getOwner(frame) : 0;
+}
+
+int MemoryManager::getProcessesInMemory() const
+{
+    std::lock_guard<std::timed_mutex> lock(memoryMutex);
+    return static_cast<int>(paging ? residentProcesses.size() : processMemoryMap.size());
+}
+
+bool MemoryManager::hasAvailableMemory() const
+{
+    std::lock_guard<std::timed_mutex> lock(memoryMutex);
+    return paging ? usedFrames < totalFrames : allocator->canFit(framesPerProcess);
+}
+
+MemoryAllocator::FreeRunHistogram MemoryManager::getFreeRunHistogram() const
+{
+    std::lock_guard<std::timed_mutex> lock(memoryMutex);
+    return allocator->getFreeRuns();
+}
+
+size_t MemoryManager::getLargestFreeBlock() const
+{
+    std::lock_guard<std::timed_mutex> lock(memoryMutex);
+    return (paging ? totalFrames - usedFrames : allocator->getLargestFree()) * frameSize;
+}
+
 void MemoryManager::printMemoryUsage() const
 {
     auto stats = getMemoryStatistics();
@@ -177,70 +650,118 @@ void MemoryManager::printMemoryUsage() const
               << "Total Memory: " << stats.totalMemory / 1024 << "KB\n"
               << "Used Memory: " << stats.usedMemory / 1024 << "KB\n"
               << "Free Memory: " << stats.freeMemory / 1024 << "KB\n"
-              << "External Fragmentation: " << stats.externalFragmentation / 1024 << "KB\n"
-              << "Processes in Memory: " << stats.processCount << "\n";
-}
-
-size_t MemoryManager::findFirstFit() const
-{
-    size_t consecutiveFree = 0;
-    size_t startFrame = 0;
-
-    for (size_t i = 0; i < frames.size(); i++)
+              << "External Fragmentation: " << stats.externalFragmentation / 1024 << "KB\n";
+    if (!paging)
+    {
+        std::cout << "Internal Fragmentation: " << stats.internalFragmentation / 1024 << "KB\n";
+    }
+    std::cout << "Processes in Memory: " << stats.processCount << "\n"
+              << "Frame Table: " << frameTable.getFootprint() / 1024 << "KB for " << totalFrames << " frames\n";
+    if (!paging)
     {
-        if (frames[i].isFree)
+        // Sizes in frames; each bucket k covers [2^k, 2^(k+1))
+        auto freeRuns = getFreeRunHistogram();
+        std::cout << "Largest Free Block: " << stats.largestFreeBlock / 1024 << "KB, "
+                  << stats.freeRuns << " free runs";
+        const char *separator = " (frames: ";
+        for (size_t sizeClass = 0; sizeClass < freeRuns.size(); ++sizeClass)
         {
-            if (consecutiveFree == 0)
-                startFrame = i;
-            consecutiveFree++;
-            if (consecutiveFree == framesPerProcess)
-                return startFrame;
+            if (freeRuns[sizeClass] == 0)
+                continue;
+
+            size_t low = size_t{1} << sizeClass;
+            std::cout << separator << low;
+            if (low > 1)
+            {
+                std::cout << "-" << (low << 1) - 1;
+            }
+            std::cout << " x" << freeRuns[sizeClass];
+            separator = ", ";
         }
-        else
+        std::cout << (stats.freeRuns > 0 ? ")\n" : "\n");
+
+        std::cout << "Placement: " << allocator->getName() << ", "
+                  << allocationFailures.load() << " of " << allocationAttempts.load() << " allocations failed\n";
+        if (extents && compactionFrames > 0)
         {
-            consecutiveFree = 0;
+            std::cout << "Compaction: " << compactionRuns.load() << " runs, "
+                      << failuresAvoided.load() << " allocation failures avoided, "
+                      << getBytesMoved() / 1024 << "KB moved in " << blocksMoved.load() << " blocks, "
+                      << compactionTime.load() / 1000 << "us (max step " << compactionLatency.getMax() / 1000 << "us)\n";
         }
     }
+    if (paging)
+    {
+        writePagingStatistics(std::cout, stats);
+    }
+}
 
-    return frames.size(); // No suitable space found
+void MemoryManager::writePagingStatistics(std::ostream &out, const MemoryStatistics &stats) const
+{
+    std::stringstream faultRate;
+    faultRate << std::fixed << std::setprecision(2)
+              << (stats.pageReferences > 0 ? 100.0 * stats.pageFaults / stats.pageReferences : 0.0);
+
+    out << "Page replacement: " << replacement.getPolicyName() << "\n"
+        << "Page faults: " << stats.pageFaults << " (" << faultRate.str() << "% of "
+        << stats.pageReferences << " references)\n"
+        << "Evictions: " << stats.evictions << ", dirty writebacks: " << stats.writebacks << "\n";
 }
 
-void MemoryManager::releaseMemory(const std::string &processName)
+bool MemoryManager::releaseMemory(Process &process)
 {
     std::lock_guard<std::timed_mutex> lock(memoryMutex);
 
-    auto processInfo = processMemoryMap.find(processName);
-    if (processInfo != processMemoryMap.end())
+    if (paging)
     {
-        size_t startFrame = processInfo->second.startFrame;
-        for (size_t i = 0; i < processInfo->second.numFrames; i++)
+        PageTable &pageTable = process.getPageTable();
+        size_t freedFrames = 0;
+        for (size_t page = 0; page < pageTable.size(); ++page)
         {
-            frames[startFrame + i].isFree = true;
-            frames[startFrame + i].processName.clear();
-        }
+            uint32_t frame = pageTable.frameOf(page);
+            if (frame != PageTable::NOT_PRESENT)
+            {
+                frameTable.clear(frame, 1);
+                framePages[frame] = PageTable::NOT_PRESENT;
+                pageTable.unmap(page);
+                --usedFrames;
+                ++freedFrames;
+            }
 
-        processMemoryMap.erase(processName);
-        processesInMemory.erase(processName);
-        updateFragmentation();
+            uint32_t slot = pageTable.getSwapSlot(page);
+            if (slot != PageTable::NO_SLOT)
+            {
+                backingStore.freeSlot(slot);
+                pageTable.setSwapSlot(page, PageTable::NO_SLOT);
+            }
+        }
+        residentProcesses.erase(process.getPID());
+        retiredReferences += process.getCommandCounter();
+        layoutImage.reset();
+
+        if (freedFrames == 0)
+            return false;
+        ++releaseCount;
+        return true;
     }
-}
 
-void MemoryManager::updateFragmentation()
-{
-    currentFragmentation.store(getExternalFragmentation());
-}
+    auto processInfo = processMemoryMap.find(process.getName());
+    if (processInfo == processMemoryMap.end())
+        return false;
 
-size_t MemoryManager::calculateRequiredFrames() const
-{
-    return framesPerProcess;
-}
+    // A block released mid-move gives back the destination frames claimed so far
+    if (moving && move.process == process.getName())
+    {
+        extents->release(move.to, std::min(move.from - move.to, move.frames));
+        moving = false;
+    }
 
-bool MemoryManager::isMemoryFull() const
-{
-    return findFirstFit() == frames.size();
+    usedFrames -= processInfo->second.numFrames;
+    roundingFrames -= processInfo->second.numFrames - processInfo->second.requestedFrames;
+    allocator->release(processInfo->second.startFrame, processInfo->second.numFrames);
+    frameTable.clear(processInfo->second.startFrame, processInfo->second.numFrames);
+    processMemoryMap.erase(processInfo);
+    layoutImage.reset();
+    ++releaseCount;
+    return true;
 }
-
-void MemoryManager::mergeAdjacentFreeFrames()
-{
-    updateFragmentation();
-}
\ No newline at end of file
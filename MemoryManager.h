@@ -5,17 +5,32 @@
 #include <map>
 #include <memory>
 #include <mutex>
-#include <set>
 #include <atomic>
 #include "Process.h"
+#include "ExtentAllocator.h"
+#include "FrameTable.h"
+#include "BackingStore.h"
+#include "Pager.h"
+#include "LatencyHistogram.h"
+#include "PageReplacement.h"
+#include "SnapshotWriter.h"
 
 struct MemoryStatistics
 {
     size_t totalMemory;
     size_t usedMemory;
     size_t freeMemory;
-    size_t externalFragmentation;
+    size_t externalFragmentation; // Free memory too fragmented for the latest request
+    size_t internalFragmentation; // Flat mode, held by blocks beyond what was requested
+    size_t largestFreeBlock;
+    size_t freeRuns; // Flat mode, runs of free frames
     int processCount;
+
+    // Paging mode only
+    uint64_t pageReferences;
+    uint64_t pageFaults;
+    uint64_t evictions;
+    uint64_t writebacks; // Dirty pages written to the backing store
 };
 
 class MemoryManager
@@ -29,31 +44,94 @@ public:
 
     // Core memory operations
     bool allocateMemory(std::shared_ptr<Process> process);
-    void releaseMemory(const std::string &processName);
+    bool releaseMemory(Process &process); // true if anything was freed
     void generateMemorySnapshot(uint32_t quantumCycle);
 
+    // Snapshots go to the snapshot-log file through a background writer,
+    // between startSnapshotLog and stopSnapshotLog (which writes the rest)
+    void startSnapshotLog();
+    void stopSnapshotLog();
+    const SnapshotWriter &getSnapshotWriter() const { return snapshotWriter; }
+    const LatencyHistogram &getSnapshotCaptureLatency() const { return snapshotCaptureLatency; } // Nanoseconds
+
+    // Paging mode (memory-mode paging): allocateMemory is a no-op and frames
+    // are mapped one page at a time on first touch. A full memory evicts the
+    // page picked by page-replacement. With a swap file the fault returns
+    // SWAPPING (with request filled in) when the victim must be written out
+    // or the page read back; the caller parks the process before handing the
+    // request to submitPageRequest, and the pager resumes it through
+    // Scheduler::resumeAfterPageIn. Requests may be submitted in any order;
+    // the pager runs them in the order they were filled in. NO_MEMORY means
+    // every frame is mid-swap.
+    enum FaultResult
+    {
+        MAPPED,
+        SWAPPING,
+        NO_MEMORY
+    };
+
+    bool isPaging() const { return paging; }
+    FaultResult handlePageFault(const std::shared_ptr<Process> &process, uint32_t page, PageRequest &request);
+    void submitPageRequest(PageRequest request);
+    void startPager();
+    void stopPager(); // Completes every queued request
+    void markAccessed(uint32_t frame, bool write) { replacement.markAccessed(frame, write); } // Lock-free, per access
+    const char *getReplacementPolicy() const { return replacement.getPolicyName(); }
+    uint64_t getPageFaults() const { return pageFaults.load(); }
+    uint64_t getEvictions() const { return evictions.load(); }
+    uint64_t getPagesIn() const { return pagesIn.load(); }
+    uint64_t getPagesOut() const { return pagesOut.load(); }
+    const LatencyHistogram &getSwapLatency() const { return swapLatency; } // Microseconds
+    void printVirtualMemoryStats() const;
+
     // Memory status and statistics
     MemoryStatistics getMemoryStatistics() const;
     size_t getExternalFragmentation() const;
-    int getProcessesInMemory() const { return processesInMemory.size(); }
-    bool hasAvailableMemory() const { return !isMemoryFull(); }
+    int getProcessesInMemory() const;
+    bool hasAvailableMemory() const;
+    uint32_t getFrameOwner(size_t frame) const; // PID, 0 if the frame is free
+    MemoryAllocator::FreeRunHistogram getFreeRunHistogram() const; // Flat mode
     void printMemoryUsage() const;
+    uint64_t getAllocationFailures() const { return allocationFailures.load(); }
+
+    // Flat mode placement, for comparing placement strategies
+    const char *getPlacement() const { return allocator->getName(); }
+    uint64_t getAllocationAttempts() const { return allocationAttempts.load(); }
+    const LatencyHistogram &getAllocationLatency() const { return allocationLatency; } // Nanoseconds
+    const LatencyHistogram &getFragmentationSamples() const { return externalFragmentationSamples; } // Bytes
+
+    // Flat mode compaction (compaction-frames in config.txt). When a request
+    // fails while enough frames are free in total, the blocks above the
+    // lowest hole slide down one at a time, at most compaction-frames frames
+    // a cycle, until the request fits or nothing is left to move. A block in
+    // transit keeps its old address until all of its frames are copied.
+    // compactStep runs once per cycle and returns true when it made room, so
+    // the caller can wake a waiter. Buddy blocks must stay aligned, so only
+    // the extent placements compact.
+    void requestCompaction(size_t bytes);
+    bool isCompacting() const { return compacting.load(); }
+    bool compactStep(uint64_t cycles);
+    size_t getLargestFreeBlock() const; // Bytes
+    uint64_t getCompactionRuns() const { return compactionRuns.load(); }
+    uint64_t getFailuresAvoided() const { return failuresAvoided.load(); } // Runs whose moves made room
+    uint64_t getBlocksMoved() const { return blocksMoved.load(); }
+    uint64_t getBytesMoved() const { return framesMoved.load() * frameSize; } // Completed moves only
+    uint64_t getCompactionTime() const { return compactionTime.load(); } // Nanoseconds, all steps
+    const LatencyHistogram &getCompactionLatency() const { return compactionLatency; } // Nanoseconds per step
+
+    // Bumped on every freed block. A caller that failed to allocate can
+    // compare it with the value read before trying to tell whether memory
+    // was freed in between.
+    uint64_t getReleaseCount() const { return releaseCount.load(); }
 
 private:
     MemoryManager();
 
-    struct Frame
-    {
-        std::string processName;
-        bool isFree{true};
-        size_t startAddress{0};
-        size_t endAddress{0};
-    };
-
     struct ProcessMemoryInfo
     {
         size_t startFrame;
-        size_t numFrames;
+        size_t numFrames;       // The whole block, rounding included
+        size_t requestedFrames; // What the process asked for
         size_t startAddress;
         size_t endAddress;
     };
@@ -62,19 +140,79 @@ private:
     size_t frameSize;
     size_t processSize;
     size_t framesPerProcess;
+    size_t lastRequestFrames;    // Size external fragmentation is reported against
+    size_t roundingFrames{0};    // Held by blocks beyond their request (buddy)
     std::map<std::string, ProcessMemoryInfo> processMemoryMap;
-    std::vector<Frame> frames;
+    std::unique_ptr<MemoryAllocator> allocator; // Where free space is, for placement
+    ExtentAllocator *extents{nullptr};          // The same allocator, if it can compact
+    FrameTable frameTable;       // Who owns each frame
     mutable std::timed_mutex memoryMutex;
-    std::atomic<size_t> currentFragmentation{0};
-    std::set<std::string> processesInMemory;
-
-    // Helper methods
-    size_t findFirstFit() const;
-    void printMemoryMap(std::ofstream &file) const;
-    void updateFragmentation();
-    void mergeAdjacentFreeFrames();
-    size_t calculateRequiredFrames() const;
-    bool isMemoryFull() const;
+    std::atomic<uint64_t> allocationFailures{0};
+    std::atomic<uint64_t> allocationAttempts{0};
+    LatencyHistogram allocationLatency;
+    LatencyHistogram externalFragmentationSamples;
+    std::atomic<uint64_t> releaseCount{0};
+
+    // Flat mode compaction, one block in transit at a time
+    struct CompactionMove
+    {
+        std::string process;
+        size_t from;
+        size_t to;
+        size_t frames;
+        size_t copied;
+    };
+    size_t compactionFrames{0};
+    std::atomic<bool> compacting{false};
+    size_t compactionTarget{0}; // Frames the current run makes room for
+    uint64_t runStartBlocks{0}; // blocksMoved when the run started
+    bool moving{false};
+    CompactionMove move{};
+    std::atomic<uint64_t> compactionRuns{0};
+    std::atomic<uint64_t> failuresAvoided{0};
+    std::atomic<uint64_t> blocksMoved{0};
+    std::atomic<uint64_t> framesMoved{0};
+    std::atomic<uint64_t> compactionTime{0};
+    LatencyHistogram compactionLatency;
+
+    bool paging{false};
+    size_t usedFrames{0};
+    size_t nextFrameHint{0};
+    std::map<int, std::weak_ptr<Process>> residentProcesses; // Paging mode, by PID
+    std::atomic<uint64_t> pageFaults{0};
+    std::vector<uint32_t> framePages; // Paging mode, page held by each frame
+    PageReplacement replacement;
+    std::atomic<uint64_t> evictions{0};
+    uint64_t retiredReferences{0}; // Page references of released processes
+
+    bool swapping{false};
+    BackingStore backingStore;
+    Pager pager;
+    std::vector<char> physicalMemory; // Frame contents, only kept when swapping
+    size_t evictionHand{0};
+    std::atomic<uint64_t> pagesIn{0};
+    std::atomic<uint64_t> pagesOut{0};
+    LatencyHistogram swapLatency;
+
+    // Memory map as of the last snapshot, shared with the snapshots still
+    // queued; dropped whenever a block or frame changes owner
+    std::shared_ptr<const MemoryLayout> layoutImage;
+    SnapshotWriter snapshotWriter;
+    bool snapshotLogStarted{false}; // Later starts append
+    LatencyHistogram snapshotCaptureLatency;
+
+    // Helper methods, called with memoryMutex held
+    MemoryStatistics getMemoryStatisticsLocked() const;
+    std::shared_ptr<const MemoryLayout> buildLayout() const;
+    std::shared_ptr<const MemoryLayout> buildFrameLayout() const;
+    void writePagingStatistics(std::ostream &out, const MemoryStatistics &stats) const;
+    size_t evictFrame(uint32_t &writeSlot);
+    void startCompaction(size_t frames);
+    bool beginMove();
+    void finishMove();
+
+    // Runs on the pager thread
+    void completePageRequests(std::vector<PageRequest> &batch);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,162 @@
+#include "PageReplacement.h"
+#include <algorithm>
+#include "PageTable.h"
+
+bool PageReplacement::parsePolicy(const std::string &name, Policy &policy)
+{
+    if (name == "fifo")
+        policy = FIFO;
+    else if (name == "lru")
+        policy = LRU;
+    else if (name == "clock")
+        policy = CLOCK;
+    else
+        return false;
+    return true;
+}
+
+const char *PageReplacement::getPolicyName() const
+{
+    switch (policy)
+    {
+    case LRU:
+        return "lru";
+    case CLOCK:
+        return "clock";
+    case FIFO:
+    default:
+        return "fifo";
+    }
+}
+
+void PageReplacement::reset(size_t frames, Policy newPolicy)
+{
+    policy = newPolicy;
+    frameCount = frames;
+    flags.reset(new std::atomic<uint8_t>[frames]);
+    for (size_t frame = 0; frame < frames; ++frame)
+    {
+        flags[frame].store(0, std::memory_order_relaxed);
+    }
+
+    loadOrder.clear();
+    loadSequence.assign(policy == FIFO ? frames : 0, 0);
+    nextLoad = 0;
+    ages.assign(policy == LRU ? frames : 0, 0);
+    evictionsSinceAging = 0;
+    hand = 0;
+}
+
+void PageReplacement::onLoad(size_t frame, bool dirty)
+{
+    flags[frame].store(dirty ? REFERENCED | DIRTY : REFERENCED, std::memory_order_relaxed);
+
+    if (policy == LRU)
+    {
+        ages[frame] = 0;
+    }
+    else if (policy == FIFO)
+    {
+        loadSequence[frame] = ++nextLoad;
+        loadOrder.push_back({static_cast<uint32_t>(frame), nextLoad});
+
+        // Every frame has at most one current entry, so dropping the ones
+        // superseded by a reload keeps the queue within the frame count
+        if (loadOrder.size() > 2 * frameCount)
+        {
+            loadOrder.erase(std::remove_if(loadOrder.begin(), loadOrder.end(),
+                                           [this](const std::pair<uint32_t, uint64_t> &entry)
+                                           { return loadSequence[entry.first] != entry.second; }),
+                            loadOrder.end());
+        }
+    }
+}
+
+size_t PageReplacement::selectVictim(const std::vector<uint32_t> &framePages)
+{
+    if (frameCount == 0)
+        return npos;
+
+    switch (policy)
+    {
+    case LRU:
+        return selectLRU(framePages);
+    case CLOCK:
+        return selectClock(framePages);
+    case FIFO:
+    default:
+        return selectFIFO(framePages);
+    }
+}
+
+size_t PageReplacement::selectFIFO(const std::vector<uint32_t> &framePages)
+{
+    // Entries for frames that are free or mid-swap are not current any more
+    // (a swapped frame is loaded again when its page arrives)
+    while (!loadOrder.empty())
+    {
+        auto entry = loadOrder.front();
+        loadOrder.pop_front();
+        if (loadSequence[entry.first] == entry.second && framePages[entry.first] != PageTable::NOT_PRESENT)
+            return entry.first;
+    }
+    return npos;
+}
+
+size_t PageReplacement::selectLRU(const std::vector<uint32_t> &framePages)
+{
+    if (++evictionsSinceAging >= AGING_INTERVAL)
+    {
+        evictionsSinceAging = 0;
+        for (size_t frame = 0; frame < frameCount; ++frame)
+        {
+            ages[frame] = static_cast<uint8_t>(ages[frame] >> 1 | (testAndClearReferenced(frame) ? 0x80 : 0));
+        }
+    }
+
+    // A set reference bit counts as the next aging step would, and a frame
+    // that would age to 0 cannot be beaten, so the scan can stop there
+    size_t victim = npos;
+    unsigned int victimAge = UINT32_MAX;
+    for (size_t scanned = 0; scanned < frameCount && victimAge > 0; ++scanned)
+    {
+        size_t frame = hand;
+        hand = hand + 1 < frameCount ? hand + 1 : 0;
+        if (framePages[frame] == PageTable::NOT_PRESENT)
+            continue;
+
+        bool referenced = (flags[frame].load(std::memory_order_relaxed) & REFERENCED) != 0;
+        unsigned int age = ages[frame] >> 1 | (referenced ? 0x80u : 0u);
+        if (age < victimAge)
+        {
+            victim = frame;
+            victimAge = age;
+        }
+    }
+    return victim;
+}
+
+size_t PageReplacement::selectClock(const std::vector<uint32_t> &framePages)
+{
+    // Two sweeps at most: the first may only clear reference bits
+    for (size_t scanned = 0; scanned < 2 * frameCount; ++scanned)
+    {
+        size_t frame = hand;
+        hand = hand + 1 < frameCount ? hand + 1 : 0;
+        if (framePages[frame] == PageTable::NOT_PRESENT)
+            continue;
+
+        if (!testAndClearReferenced(frame))
+            return frame;
+    }
+    return npos;
+}
+
+bool PageReplacement::testAndClearReferenced(size_t frame)
+{
+    if ((flags[frame].load(std::memory_order_relaxed) & REFERENCED) == 0)
+        return false;
+
+    flags[frame].fetch_and(static_cast<uint8_t>(~REFERENCED), std::memory_order_relaxed);
+    return true;
+}
@@ -0,0 +1,86 @@
+#ifndef PAGE_REPLACEMENT_H
+#define PAGE_REPLACEMENT_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+// Chooses which resident page to evict when paging mode runs out of frames
+// (page-replacement in config.txt). State is kept per frame:
+//   fifo  - evicts the page loaded longest ago
+//   lru   - aging: every AGING_INTERVAL evictions each frame's 8-bit age is
+//           shifted right with its reference bit shifted in at the top, and
+//           the frame with the lowest age goes
+//   clock - second chance: the hand clears reference bits until it finds a
+//           frame that was not referenced since its last pass
+// The reference and dirty bits are set lock-free by the cores on every
+// access; everything else is called by MemoryManager with its lock held.
+// The offline optimal policy lives in tools/PageReplay.cpp since it needs
+// the future reference string.
+class PageReplacement
+{
+public:
+    enum Policy
+    {
+        FIFO,
+        LRU,
+        CLOCK
+    };
+
+    static constexpr size_t npos = SIZE_MAX;
+    static constexpr uint32_t AGING_INTERVAL = 32;
+
+    static bool parsePolicy(const std::string &name, Policy &policy);
+
+    void reset(size_t frames, Policy policy);
+    Policy getPolicy() const { return policy; }
+    const char *getPolicyName() const;
+
+    // A page was just mapped into frame; dirty means the frame holds the
+    // only copy of it (nothing current in the backing store)
+    void onLoad(size_t frame, bool dirty);
+
+    void markAccessed(size_t frame, bool write)
+    {
+        uint8_t bits = write ? REFERENCED | DIRTY : REFERENCED;
+        if ((flags[frame].load(std::memory_order_relaxed) & bits) != bits)
+        {
+            flags[frame].fetch_or(bits, std::memory_order_relaxed);
+        }
+    }
+
+    bool isDirty(size_t frame) const { return (flags[frame].load(std::memory_order_relaxed) & DIRTY) != 0; }
+
+    // Victim among the frames whose framePages entry is a page, not
+    // NOT_PRESENT (free or still being swapped), or npos if there is none
+    size_t selectVictim(const std::vector<uint32_t> &framePages);
+
+private:
+    static constexpr uint8_t REFERENCED = 1;
+    static constexpr uint8_t DIRTY = 2;
+
+    Policy policy{FIFO};
+    size_t frameCount{0};
+    std::unique_ptr<std::atomic<uint8_t>[]> flags;
+
+    // fifo: frames in load order, tagged with the load so entries left by a
+    // frame that was freed or reloaded since can be skipped
+    std::deque<std::pair<uint32_t, uint64_t>> loadOrder;
+    std::vector<uint64_t> loadSequence;
+    uint64_t nextLoad{0};
+
+    std::vector<uint8_t> ages; // lru
+    uint32_t evictionsSinceAging{0};
+    size_t hand{0}; // clock, and where the lru scan starts
+
+    size_t selectFIFO(const std::vector<uint32_t> &framePages);
+    size_t selectLRU(const std::vector<uint32_t> &framePages);
+    size_t selectClock(const std::vector<uint32_t> &framePages);
+    bool testAndClearReferenced(size_t frame);
+};
+
+#endif
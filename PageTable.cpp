@@ -0,0 +1,29 @@
+#include "PageTable.h"
+
+PageTable::PageTable(size_t pages)
+    : pageCount(pages),
+      entries(new std::atomic<uint32_t>[pages]),
+      swapSlots(new uint32_t[pages])
+{
+    for (size_t i = 0; i < pageCount; ++i)
+    {
+        entries[i].store(NOT_PRESENT, std::memory_order_relaxed);
+        swapSlots[i] = NO_SLOT;
+    }
+}
+
+void PageTable::map(size_t page, uint32_t frame)
+{
+    if (entries[page].exchange(frame, std::memory_order_release) == NOT_PRESENT)
+    {
+        residentPages.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void PageTable::unmap(size_t page)
+{
+    if (entries[page].exchange(NOT_PRESENT, std::memory_order_release) != NOT_PRESENT)
+    {
+        residentPages.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
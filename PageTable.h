@@ -0,0 +1,44 @@
+#ifndef PAGE_TABLE_H
+#define PAGE_TABLE_H
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+// Virtual page -> physical frame map of one process in paging mode. Entries
+// are atomics so the running core can check residency without a lock while
+// MemoryManager maps and unmaps frames under its own mutex.
+class PageTable
+{
+public:
+    static constexpr uint32_t NOT_PRESENT = UINT32_MAX;
+    static constexpr uint32_t NO_SLOT = UINT32_MAX; // Same value as BackingStore::NO_SLOT
+
+    explicit PageTable(size_t pages = 0);
+
+    size_t size() const { return pageCount; }
+    bool isPresent(size_t page) const { return frameOf(page) != NOT_PRESENT; }
+    uint32_t frameOf(size_t page) const { return entries[page].load(std::memory_order_acquire); }
+
+    // Called by MemoryManager with its lock held
+    void map(size_t page, uint32_t frame);
+    void unmap(size_t page);
+
+    // Backing store slot holding the page while it is swapped out
+    uint32_t getSwapSlot(size_t page) const { return swapSlots[page]; }
+    void setSwapSlot(size_t page, uint32_t slot) { swapSlots[page] = slot; }
+
+    size_t getResidentPages() const { return residentPages.load(std::memory_order_relaxed); }
+    uint64_t getPageFaults() const { return pageFaults.load(std::memory_order_relaxed); }
+    void countFault() { pageFaults.fetch_add(1, std::memory_order_relaxed); }
+
+private:
+    size_t pageCount;
+    std::unique_ptr<std::atomic<uint32_t>[]> entries;
+    std::unique_ptr<uint32_t[]> swapSlots; // NO_SLOT when the page has none
+    std::atomic<size_t> residentPages{0};
+    std::atomic<uint64_t> pageFaults{0};
+};
+
+#endif
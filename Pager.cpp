@@ -0,0 +1,71 @@
+#include "Pager.h"
+#include <algorithm>
+
+void Pager::start(BatchHandler batchHandler)
+{
+    stop();
+
+    handler = std::move(batchHandler);
+    stopping = false;
+    pagerThread = std::thread(&Pager::run, this);
+}
+
+void Pager::stop()
+{
+    if (!pagerThread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueCv.notify_one();
+    pagerThread.join();
+}
+
+uint64_t Pager::reserveSequence()
+{
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return nextReserved++;
+}
+
+void Pager::submit(PageRequest request)
+{
+    bool runnable;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        runnable = request.sequence == nextToRun;
+        queue.emplace(request.sequence, std::move(request));
+    }
+    if (runnable)
+    {
+        queueCv.notify_one();
+    }
+}
+
+void Pager::run()
+{
+    std::vector<PageRequest> batch;
+    std::unique_lock<std::mutex> lock(queueMutex);
+    while (true)
+    {
+        queueCv.wait(lock, [this]
+                     { return stopping || (!queue.empty() && queue.begin()->first == nextToRun); });
+        if (queue.empty())
+            break;
+
+        // The longest run without a gap; when stopping, whatever is left
+        auto it = queue.begin();
+        while (it != queue.end() && batch.size() < MAX_BATCH && (it->first == nextToRun || stopping))
+        {
+            nextToRun = it->first + 1;
+            batch.push_back(std::move(it->second));
+            it = queue.erase(it);
+        }
+
+        lock.unlock();
+        handler(batch);
+        batch.clear();
+        lock.lock();
+    }
+}
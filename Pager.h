@@ -0,0 +1,70 @@
+#ifndef PAGER_H
+#define PAGER_H
+
+#include <vector>
+#include <map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+#include "Process.h"
+
+// One page fault that needs swap I/O. The frame is already reserved for the
+// faulting process; the victim page that held it (if any) goes out to
+// writeSlot first, then the faulting page comes in from readSlot, or the
+// frame is zeroed on first touch.
+struct PageRequest
+{
+    std::shared_ptr<Process> process; // Parked until the request completes
+    uint32_t page;
+    uint32_t frame;
+    uint32_t writeSlot;
+    uint32_t readSlot;
+    std::chrono::steady_clock::time_point submitted;
+    uint64_t sequence; // From reserveSequence, taken when the slots were assigned
+};
+
+// Background thread that does the swap I/O so cores never wait on it.
+// Requests are handled strictly in sequence order, the order MemoryManager
+// assigned their frames and slots in under its lock, not the order they
+// happen to be submitted in after it is dropped: a request that arrives
+// early waits for the ones before it. So a page written out and faulted
+// straight back in is read only after the write, and a slot freed and
+// handed out again is written by its new owner after the old owner's
+// pending write. Requests are taken off the queue in batches of up to
+// MAX_BATCH so one flush and one lock round trip cover the whole batch.
+class Pager
+{
+public:
+    static constexpr size_t MAX_BATCH = 64;
+
+    using BatchHandler = std::function<void(std::vector<PageRequest> &)>;
+
+    ~Pager() { stop(); }
+
+    void start(BatchHandler handler);
+    void stop(); // Finishes every queued request first
+    bool isRunning() const { return pagerThread.joinable(); }
+
+    // Every reserved sequence number must be submitted, or the requests
+    // after it wait forever
+    uint64_t reserveSequence();
+    void submit(PageRequest request);
+
+private:
+    std::thread pagerThread;
+    std::mutex queueMutex;
+    std::condition_variable queueCv;
+    std::map<uint64_t, PageRequest> queue; // By sequence
+    uint64_t nextReserved{0};
+    uint64_t nextToRun{0};
+    bool stopping{false};
+    BatchHandler handler;
+
+    void run();
+};
+
+#endif
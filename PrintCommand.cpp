@@ -4,7 +4,6 @@
 #include <chrono>
 #include <iomanip>
 #include <sstream>
-#include "CLI.h"
 
 // PrintCommand::PrintCommand(int pid, const std::string &toPrint)
 //     : ICommand(pid, CommandType::PRINT), toPrint(toPrint)
@@ -5,6 +5,7 @@
 #include <chrono>
 #include <thread>
 #include <iomanip>
+#include <algorithm>
 #include "Utils.h"
 
 Process::Process(int pid, const std::string &name)
@@ -14,7 +15,11 @@ Process::Process(int pid, const std::string &name)
       cpuCoreID(-1),
       commandCounter(0),
       quantumTime(0),
-      creationTime(std::chrono::system_clock::now())
+      creationTime(std::chrono::system_clock::now()),
+      memorySize(generateMemorySize()),
+      pageTable(Config::getInstance().isPagingEnabled()
+                    ? (memorySize + Config::getInstance().getMemPerFrame() - 1) / Config::getInstance().getMemPerFrame()
+                    : 0)
 {
     // Generate random number of instructions based on config
     int numInstructions = generateInstructionCount();
@@ -32,6 +37,7 @@ void Process::addCommand(ICommand::CommandType commandType)
     {
         auto command = std::make_shared<PrintCommand>(pid, name);
         commandList.push_back(command);
+        linesOfCode = static_cast<int>(commandList.size());
     }
 }
 
@@ -62,7 +68,41 @@ void Process::moveToNextLine()
 
 bool Process::isFinished()
 {
-    return commandCounter >= commandList.size();
+    return commandCounter >= linesOfCode;
+}
+
+uint32_t Process::pageOfInstruction(int instruction) const
+{
+    // The program walks its address space front to back, and each
+    // instruction touches one of the next few pages, picked by a hash of
+    // (pid, instruction). This gives reuse within a small working set
+    // without storing a reference string per process.
+    constexpr uint64_t WORKING_SET = 4;
+
+    uint64_t pages = pageTable.size();
+    uint64_t lines = std::max(1, linesOfCode.load());
+    uint64_t base = static_cast<uint64_t>(instruction) * pages / lines;
+
+    return static_cast<uint32_t>((base + accessHash(instruction) % std::min(WORKING_SET, pages)) % pages);
+}
+
+bool Process::writesPage(int instruction) const
+{
+    // About one access in four is a store, decided by the top bits of the
+    // hash while the page choice uses the bottom ones
+    return accessHash(instruction) >> 62 == 0;
+}
+
+uint64_t Process::accessHash(int instruction) const
+{
+    uint64_t hash = (static_cast<uint64_t>(pid) << 32 | static_cast<uint32_t>(instruction)) * 0x9E3779B97F4A7C15ULL;
+    return hash ^ hash >> 29;
+}
+
+void Process::releaseInstructions()
+{
+    // Called by the core that ran the process, once it has finished
+    std::vector<std::shared_ptr<ICommand>>().swap(commandList);
 }
 
 int Process::generateInstructionCount() const
@@ -71,13 +111,32 @@ int Process::generateInstructionCount() const
     int min = config.getMinInstructions();
     int max = config.getMaxInstructions();
 
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    // A fixed seed makes every run generate the same workload; mixing in the
+    // PID keeps it independent of which thread creates the process first
+    uint32_t seed = config.getWorkloadSeed();
+    std::mt19937 gen(seed != 0 ? seed + static_cast<uint32_t>(pid) : std::random_device{}());
     std::uniform_int_distribution<> dis(min, max);
 
     return dis(gen);
 }
 
+uint32_t Process::generateMemorySize() const
+{
+    auto &config = Config::getInstance();
+    uint32_t frameSize = config.getMemPerFrame();
+    uint32_t minFrames = config.getMemPerProc() / frameSize;
+    uint32_t maxFrames = config.getMaxMemPerProc() / frameSize;
+    if (maxFrames <= minFrames)
+        return config.getMemPerProc();
+
+    // Own stream, so the instruction count for the same seed does not change
+    uint32_t seed = config.getWorkloadSeed();
+    std::mt19937 gen(seed != 0 ? (seed + static_cast<uint32_t>(pid)) ^ 0x9e3779b9u : std::random_device{}());
+    std::uniform_int_distribution<uint32_t> dis(minFrames, maxFrames);
+
+    return dis(gen) * frameSize;
+}
+
 void Process::displayProcessInfo()
 {
     std::string processInfo;
@@ -101,6 +160,49 @@ void Process::displayProcessInfo()
     std::cout << processInfo;
 }
 
+void Process::setNice(int value)
+{
+    nice = std::max(-20, std::min(19, value));
+}
+
+uint32_t Process::getWeight() const
+{
+    // Linux sched_prio_to_weight: each nice step is roughly 10% of CPU share
+    static const uint32_t niceToWeight[40] = {
+        88761, 71755, 56483, 46273, 36291,
+        29154, 23254, 18705, 14949, 11916,
+        9548, 7620, 6100, 4904, 3906,
+        3121, 2501, 1991, 1586, 1277,
+        1024, 820, 655, 526, 423,
+        335, 272, 215, 172, 137,
+        110, 87, 70, 56, 45,
+        36, 29, 23, 18, 15};
+
+    return niceToWeight[nice.load() + 20];
+}
+
+void Process::setArrivalCycle(uint64_t cycle)
+{
+    arrivalCycle = cycle;
+    readySinceCycle = cycle;
+}
+
+void Process::recordDispatch(uint64_t cycle)
+{
+    uint64_t readySince = readySinceCycle.load();
+    if (cycle > readySince)
+    {
+        waitingCycles += cycle - readySince;
+    }
+    ++dispatchCount;
+
+    bool expected = false;
+    if (hasStarted.compare_exchange_strong(expected, true))
+    {
+        firstRunCycle = cycle;
+    }
+}
+
 // Getters and setters
 int Process::getPID() const { return pid; }
 std::string Process::getName() const { return name; }
@@ -132,5 +234,5 @@ int Process::getCommandCounter()
 
 int Process::getLinesOfCode()
 {
-    return static_cast<int>(commandList.size());
+    return linesOfCode.load();
 }
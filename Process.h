@@ -9,6 +9,7 @@
 #include "ICommand.h"
 #include "Config.h"
 #include "PrintCommand.h"
+#include "PageTable.h"
 
 class Process
 {
@@ -29,6 +30,9 @@ public:
     void executeCurrentCommand(int coreID);
     void moveToNextLine();
 
+    // Frees the instruction list of a finished process; line counts are kept
+    void releaseInstructions();
+
     // Process status
     bool isFinished();
     int getCommandCounter();
@@ -47,9 +51,50 @@ public:
 
     // Round Robin support
     void resetQuantumTime() { quantumTime = 0; }
-    uint32_t getQuantumTime() { return quantumTime.load(); }
+    uint32_t getQuantumTime() const { return quantumTime.load(); }
     void incrementQuantumTime() { ++quantumTime; }
 
+    // MLFQ support, level 0 is the highest priority
+    uint32_t getPriorityLevel() const { return priorityLevel.load(); }
+    void setPriorityLevel(uint32_t level) { priorityLevel = level; }
+
+    // CFS support, nice is clamped to [-20, 19] like the Linux scale
+    static constexpr uint32_t NICE_0_WEIGHT = 1024;
+    int getNice() const { return nice.load(); }
+    void setNice(int value);
+    uint32_t getWeight() const;
+    uint64_t getVruntime() const { return vruntime.load(); }
+    void setVruntime(uint64_t value) { vruntime = value; }
+    void addVruntime(uint64_t delta) { vruntime += delta; }
+
+    // Weight the scheduler counts in its runnable sum, 0 while not counted
+    uint32_t getCountedWeight() const { return countedWeight.load(); }
+    void setCountedWeight(uint32_t weight) { countedWeight = weight; }
+
+    // Scheduling metrics, in CPU cycles. Waiting time is the total spent in
+    // the ready queues, from each markReady to the following dispatch.
+    void setArrivalCycle(uint64_t cycle);
+    void markReady(uint64_t cycle) { readySinceCycle = cycle; }
+    void recordDispatch(uint64_t cycle);
+    void setFinishCycle(uint64_t cycle) { finishCycle = cycle; }
+    uint64_t getArrivalCycle() const { return arrivalCycle.load(); }
+    uint64_t getFirstRunCycle() const { return firstRunCycle.load(); }
+    uint64_t getFinishCycle() const { return finishCycle.load(); }
+    uint64_t getWaitingCycles() const { return waitingCycles.load(); }
+    uint32_t getDispatchCount() const { return dispatchCount.load(); }
+    bool hasRun() const { return hasStarted.load(); }
+
+    // Bytes of memory the process needs, between mem-per-proc and max-mem-per-proc
+    uint32_t getMemorySize() const { return memorySize; }
+
+    // Paging mode: the page table covers getMemorySize() bytes and is empty in
+    // flat mode. pageOfInstruction is the page instruction k touches, and
+    // writesPage whether that access is a store.
+    PageTable &getPageTable() { return pageTable; }
+    const PageTable &getPageTable() const { return pageTable; }
+    uint32_t pageOfInstruction(int instruction) const;
+    bool writesPage(int instruction) const;
+
     // Process-smi command
     void displayProcessInfo();
 
@@ -60,17 +105,38 @@ private:
     std::atomic<ProcessState> state; 
     std::atomic<int> cpuCoreID;
     std::chrono::system_clock::time_point creationTime;
+    const uint32_t memorySize;
 
     // Command management
     std::vector<std::shared_ptr<ICommand>> commandList;
     std::atomic<int> commandCounter; 
+    std::atomic<int> linesOfCode{0};
 
     // Round Robin timing
     std::atomic<uint32_t> quantumTime; 
+    std::atomic<uint32_t> priorityLevel{0};
+
+    // CFS accounting
+    std::atomic<int> nice{0};
+    std::atomic<uint64_t> vruntime{0};
+    std::atomic<uint32_t> countedWeight{0};
+
+    // Scheduling metrics
+    std::atomic<uint64_t> arrivalCycle{0};
+    std::atomic<uint64_t> firstRunCycle{0};
+    std::atomic<uint64_t> finishCycle{0};
+    std::atomic<uint64_t> readySinceCycle{0};
+    std::atomic<uint64_t> waitingCycles{0};
+    std::atomic<uint32_t> dispatchCount{0};
+    std::atomic<bool> hasStarted{false};
 
     mutable std::mutex processMutex;
 
+    PageTable pageTable;
+
     int generateInstructionCount() const;
+    uint32_t generateMemorySize() const;
+    uint64_t accessHash(int instruction) const;
 };
 
 #endif
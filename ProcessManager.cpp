@@ -3,10 +3,11 @@
 #include <iomanip>
 #include <sstream>
 #include <chrono>
+#include <algorithm>
 #include "Utils.h"
 #include "MemoryManager.h"
 
-void ProcessManager::createProcess(const std::string &name)
+std::shared_ptr<Process> ProcessManager::createProcess(const std::string &name)
 {
     if (name.empty())
     {
@@ -14,7 +15,8 @@ void ProcessManager::createProcess(const std::string &name)
     }
 
     std::unique_lock<std::mutex> lock(processesMutex);
-    if (processes.find(name) != processes.end())
+    auto existing = processes.find(name);
+    if (existing != processes.end() && !existing->second.expired())
     {
         throw std::runtime_error("Process with name '" + name + "' already exists");
     }
@@ -23,18 +25,18 @@ void ProcessManager::createProcess(const std::string &name)
     {
         auto process = std::make_shared<Process>(nextPID++, name);
         processes[name] = process;
-
-        // Release lock before scheduling to prevent deadlock
-        lock.unlock();
-
-        bool memoryAllocated = MemoryManager::getInstance().allocateMemory(process);
-        if (!memoryAllocated)
+        if (processes.size() >= pruneThreshold)
         {
-            std::cout << "Warning: Could not allocate memory for process " << name
-                      << ". Process will continue in ready queue.\n";
+            pruneFinishedLocked();
         }
 
+        // Release lock before scheduling to prevent deadlock. Memory is
+        // allocated when the process is first dispatched, which parks it
+        // until a block is freed if none fits
+        lock.unlock();
+
         Scheduler::getInstance().addProcess(process);
+        return process;
     }
     catch (const std::exception &e)
     {
@@ -51,54 +53,50 @@ std::shared_ptr<Process> ProcessManager::getProcess(const std::string &name)
         auto it = processes.find(name);
         if (it != processes.end())
         {
-            result = it->second;
+            result = it->second.lock();
         }
     }
     return result;
 }
 
-void ProcessManager::listProcesses()
+void ProcessManager::pruneFinishedLocked()
 {
-    std::vector<std::shared_ptr<Process>> processSnapshot;
-    int totalCores;
-    int activeCount = 0;
-
+    for (auto it = processes.begin(); it != processes.end();)
     {
-        std::lock_guard<std::mutex> lock(processesMutex);
-        totalCores = Config::getInstance().getNumCPU();
-
-        // Create a snapshot of processes to prevent holding the lock during output
-        for (const auto &pair : processes)
+        if (it->second.expired())
         {
-            processSnapshot.push_back(pair.second);
-            if (pair.second->getState() == Process::RUNNING)
-            {
-                activeCount++;
-            }
+            it = processes.erase(it);
+        }
+        else
+        {
+            ++it;
         }
     }
+    pruneThreshold = std::max<size_t>(64, processes.size() * 2);
+}
+
+void ProcessManager::listProcesses(size_t page)
+{
+    // Read the scheduler's published state rather than walking the process
+    // table, so listing never holds a lock the cores or createProcess need
+    auto &scheduler = Scheduler::getInstance();
+    auto running = scheduler.getRunningProcesses();
+
+    int totalCores = Config::getInstance().getNumCPU();
+    int activeCount = running.size();
 
     std::cout << "CPU utilization: " << (activeCount * 100 / totalCores) << "%\n";
     std::cout << "Cores used: " << activeCount << "\n";
     std::cout << "Cores available: " << (totalCores - activeCount) << "\n\n";
 
     std::cout << "Running processes:\n";
-    for (const auto &process : processSnapshot)
+    for (const auto &process : running)
     {
-        if (process->getState() == Process::RUNNING)
-        {
-            process->displayProcessInfo();
-        }
+        process->displayProcessInfo();
     }
 
-    std::cout << "\nFinished processes:\n";
-    for (const auto &process : processSnapshot)
-    {
-        if (process->getState() == Process::FINISHED)
-        {
-            process->displayProcessInfo();
-        }
-    }
+    std::cout << "\n";
+    scheduler.writeFinishedProcesses(std::cout, page);
 }
 
 void ProcessManager::startBatchProcessing()
@@ -125,6 +123,7 @@ void ProcessManager::stopBatchProcessing()
         if (batchProcessingActive)
         {
             batchProcessingActive = false;
+            Scheduler::getInstance().notifyCycleWaiters();
             if (batchProcessThread.joinable())
             {
                 batchProcessThread.join();
@@ -138,9 +137,18 @@ void ProcessManager::batchProcessingLoop()
     int processCounter = 1;
     uint64_t lastCycle = Scheduler::getInstance().getCPUCycles();
     const uint64_t batchFreq = Config::getInstance().getBatchProcessFreq();
+    const bool virtualTime = Config::getInstance().isVirtualClock();
 
     while (batchProcessingActive)
     {
+        // In virtual time, block on the clock itself instead of polling it
+        if (virtualTime)
+        {
+            Scheduler::getInstance().waitForCycle(lastCycle + batchFreq, batchProcessingActive);
+            if (!batchProcessingActive)
+                break;
+        }
+
         uint64_t currentCycle = Scheduler::getInstance().getCPUCycles();
 
         // Check if enough cycles have passed since last process creation
@@ -161,8 +169,12 @@ void ProcessManager::batchProcessingLoop()
         }
 
         // Longer sleep time to reduce CPU usage
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        if (!virtualTime)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
     }
+    Scheduler::getInstance().releaseCycle();
 }
 
 std::string ProcessManager::generateProcessName() const
@@ -18,9 +18,9 @@ public:
         return instance;
     }
 
-    void createProcess(const std::string &name);
+    std::shared_ptr<Process> createProcess(const std::string &name);
     std::shared_ptr<Process> getProcess(const std::string &name);
-    void listProcesses();
+    void listProcesses(size_t page = 0);
     void startBatchProcessing();
     void stopBatchProcessing();
 
@@ -28,7 +28,10 @@ private:
     ProcessManager() : nextPID(1), batchProcessingActive(false), lastProcessCreationCycle(0) {}
     ~ProcessManager() { stopBatchProcessing(); }
 
-    std::map<std::string, std::shared_ptr<Process>> processes;
+    // The scheduler owns processes until they finish; finished ones expire
+    // here and are pruned whenever the table has doubled since the last sweep
+    std::map<std::string, std::weak_ptr<Process>> processes;
+    size_t pruneThreshold{64};
     std::atomic<int> nextPID;
     std::atomic<bool> batchProcessingActive;
     std::thread batchProcessThread;
@@ -38,6 +41,7 @@ private:
 
     void batchProcessingLoop();
     std::string generateProcessName() const;
+    void pruneFinishedLocked();
 };
 
 #endif
\ No newline at end of file
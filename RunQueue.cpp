@@ -0,0 +1,95 @@
+#include "RunQueue.h"
+#include <algorithm>
+
+RunQueue::RunQueue(Ordering ordering)
+    : ordering(ordering)
+{
+}
+
+uint64_t RunQueue::keyOf(Process &process) const
+{
+    switch (ordering)
+    {
+    case BY_REMAINING:
+        return static_cast<uint64_t>(process.getLinesOfCode() - process.getCommandCounter());
+    case BY_VRUNTIME:
+        return process.getVruntime();
+    case BY_LEVEL:
+    default:
+        return process.getPriorityLevel();
+    }
+}
+
+void RunQueue::push(std::shared_ptr<Process> process)
+{
+    std::lock_guard<std::mutex> lock(queueMutex);
+
+    if (ordering == BY_VRUNTIME && process->getVruntime() < minVruntime)
+    {
+        process->setVruntime(minVruntime);
+    }
+
+    uint64_t key = keyOf(*process);
+    heap.push_back({key, nextSequence++, std::move(process)});
+    std::push_heap(heap.begin(), heap.end());
+    publishLocked();
+}
+
+std::shared_ptr<Process> RunQueue::pop()
+{
+    // Cheap check so an empty queue never costs a lock
+    if (empty())
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return popLocked();
+}
+
+std::shared_ptr<Process> RunQueue::steal()
+{
+    if (empty())
+        return nullptr;
+
+    std::unique_lock<std::mutex> lock(queueMutex, std::try_to_lock);
+    if (!lock.owns_lock())
+        return nullptr;
+
+    return popLocked();
+}
+
+void RunQueue::boost()
+{
+    if (ordering != BY_LEVEL || empty())
+        return;
+
+    std::lock_guard<std::mutex> lock(queueMutex);
+    for (auto &entry : heap)
+    {
+        entry.process->setPriorityLevel(0);
+        entry.key = 0;
+    }
+    std::make_heap(heap.begin(), heap.end());
+    publishLocked();
+}
+
+std::shared_ptr<Process> RunQueue::popLocked()
+{
+    if (heap.empty())
+        return nullptr;
+
+    std::pop_heap(heap.begin(), heap.end());
+    if (ordering == BY_VRUNTIME)
+    {
+        minVruntime = std::max(minVruntime, heap.back().key);
+    }
+    auto process = std::move(heap.back().process);
+    heap.pop_back();
+    publishLocked();
+    return process;
+}
+
+void RunQueue::publishLocked()
+{
+    count.store(heap.size(), std::memory_order_relaxed);
+    minKey.store(heap.empty() ? UINT64_MAX : heap.front().key, std::memory_order_relaxed);
+}
@@ -0,0 +1,77 @@
+#ifndef RUN_QUEUE_H
+#define RUN_QUEUE_H
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include "Process.h"
+
+// Ready queue owned by a single simulated core; idle cores steal from it.
+//
+// Processes are kept in a binary min-heap keyed on (key, arrival sequence),
+// so push, pop and steal are all O(log n) and equal keys stay FIFO. The key
+// depends on the ordering the queue was built with:
+//   BY_LEVEL     - the process's priority level (FCFS and RR use level 0
+//                  throughout, so this is plain FIFO; MLFQ serves level 0 first)
+//   BY_REMAINING - instructions left to execute (SJF / SRTF)
+//   BY_VRUNTIME  - weighted virtual runtime (CFS). The queue keeps a
+//                  monotonic minimum vruntime, and arrivals are placed no
+//                  lower than it so a newcomer cannot starve everyone else.
+class RunQueue
+{
+public:
+    enum Ordering
+    {
+        BY_LEVEL,
+        BY_REMAINING,
+        BY_VRUNTIME
+    };
+
+    explicit RunQueue(Ordering ordering = BY_LEVEL);
+
+    void push(std::shared_ptr<Process> process);
+    std::shared_ptr<Process> pop();
+    std::shared_ptr<Process> steal();
+
+    // Moves every queued process back to level 0 (MLFQ priority boost)
+    void boost();
+
+    // Key of the best queued process, UINT64_MAX when empty. Lock-free so a
+    // running core can poll it every cycle for preemption checks.
+    uint64_t peekKey() const { return minKey.load(std::memory_order_relaxed); }
+    uint64_t keyOf(Process &process) const;
+
+    size_t size() const { return count.load(std::memory_order_relaxed); }
+    bool empty() const { return size() == 0; }
+
+private:
+    struct Entry
+    {
+        uint64_t key;
+        uint64_t sequence;
+        std::shared_ptr<Process> process;
+
+        // std::push_heap builds a max-heap, so invert for a min-heap
+        bool operator<(const Entry &other) const
+        {
+            if (key != other.key)
+                return key > other.key;
+            return sequence > other.sequence;
+        }
+    };
+
+    const Ordering ordering;
+    std::vector<Entry> heap;
+    uint64_t nextSequence{0};
+    std::mutex queueMutex;
+    std::atomic<size_t> count{0};
+    std::atomic<uint64_t> minKey{UINT64_MAX};
+    uint64_t minVruntime{0};
+
+    std::shared_ptr<Process> popLocked();
+    void publishLocked();
+};
+
+#endif
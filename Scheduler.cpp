@@ -10,9 +10,43 @@
 #include "MemoryManager.h"
 
 Scheduler::Scheduler()
+    : cycleBarrier([this]
+                   { return beginPhase(); },
+                   [this]
+                   { return completeCycle(); })
 {
-    size_t numCPUs = Config::getInstance().getNumCPU();
-    coreStatus.resize(numCPUs, false);
+    // Construct the memory manager first so it outlives the worker threads
+    MemoryManager::getInstance();
+
+    const auto &config = Config::getInstance();
+    size_t numCPUs = config.getNumCPU();
+    numLevels = config.getSchedulerPolicy() == Config::MLFQ ? config.getMLFQLevels() : 1;
+    RunQueue::Ordering ordering = RunQueue::BY_LEVEL;
+    switch (config.getSchedulerPolicy())
+    {
+    case Config::SJF:
+        ordering = SJFPolicy::ordering;
+        break;
+    case Config::SRTF:
+        ordering = SRTFPolicy::ordering;
+        break;
+    case Config::CFS:
+        ordering = CFSPolicy::ordering;
+        break;
+    default:
+        break;
+    }
+
+    coreStatus = std::vector<std::atomic<bool>>(numCPUs);
+    cores.resize(numCPUs);
+    coreSlots.resize(numCPUs);
+    for (size_t i = 0; i < numCPUs; ++i)
+    {
+        coreStatus[i] = false;
+        cores[i].id = static_cast<int>(i);
+        runQueues.push_back(std::make_unique<RunQueue>(ordering));
+    }
+    finishedHistory.open(config.getFinishedRetention(), config.getFinishedArchive());
 }
 
 void Scheduler::startScheduling()
@@ -25,11 +59,52 @@ void Scheduler::startScheduling()
 
     // Reset CPU cycles
     cpuCycles.store(0);
+    {
+        std::lock_guard<std::mutex> lock(clockMutex);
+        clockHolds.clear();
+        nextWakeCycle = UINT64_MAX;
+    }
+    virtualTime = Config::getInstance().isVirtualClock();
+
+    const auto &config = Config::getInstance();
+    delaysPerExec = config.getDelaysPerExec();
+    snapshotInterval = config.getQuantumCycles();
+    boostInterval = config.getSchedulerPolicy() == Config::MLFQ ? config.getMLFQBoostCycles() : 0;
+    sliceBatching = config.isSliceBatching();
+    memorySnapshots = config.areMemorySnapshotsEnabled();
+    pagingMode = config.isPagingEnabled();
+    lastMemorySnapshotCycle = 0;
+    phaseLength = computePhaseLength();
+    MemoryManager::getInstance().startPager();
+    MemoryManager::getInstance().startSnapshotLog();
+
+    if (!config.getTraceFile().empty() && !tracer.start(config.getTraceFile(), cores.size()))
+    {
+        std::cerr << "Could not open trace file " << config.getTraceFile() << ", tracing disabled\n";
+    }
 
-    int numCPUs = Config::getInstance().getNumCPU();
-    for (int i = 0; i < numCPUs; ++i)
+    // Resolve the policy once; each core runs a loop compiled for it
+    switch (config.getSchedulerPolicy())
     {
-        cpuThreads.emplace_back(&Scheduler::executeProcesses, this);
+    case Config::ROUND_ROBIN:
+        startCores(RoundRobinPolicy(config));
+        break;
+    case Config::MLFQ:
+        startCores(MLFQPolicy(config));
+        break;
+    case Config::SJF:
+        startCores(SJFPolicy(config));
+        break;
+    case Config::SRTF:
+        startCores(SRTFPolicy(config));
+        break;
+    case Config::CFS:
+        startCores(CFSPolicy(config, runnableCount, runnableWeight));
+        break;
+    case Config::FCFS:
+    default:
+        startCores(FCFSPolicy(config));
+        break;
     }
 
     // Start the cycle counter thread
@@ -37,27 +112,61 @@ void Scheduler::startScheduling()
     cycleCounterThread = std::thread(&Scheduler::cycleCounterLoop, this);
 }
 
+template <typename Policy>
+void Scheduler::startCores(const Policy &policy)
+{
+    // Simulated cores are plain objects stepped by a fixed pool of host
+    // threads: worker w owns cores w, w + W, w + 2W, ...
+    size_t numWorkers = std::max<size_t>(1, std::min<size_t>(Config::getInstance().getHostThreads(), cores.size()));
+    cycleBarrier.reset(numWorkers);
+    scheduleCores = [this, policy](uint64_t cycle)
+    { return scheduleAllCores(policy, cycle); };
+
+    for (size_t w = 0; w < numWorkers; ++w)
+    {
+        std::vector<Core *> ownedCores;
+        for (size_t i = w; i < cores.size(); i += numWorkers)
+        {
+            ownedCores.push_back(&cores[i]);
+        }
+        workerThreads.emplace_back(&Scheduler::executeProcesses<Policy>, this, policy, std::move(ownedCores));
+    }
+}
+
 void Scheduler::stopScheduling()
 {
     processingActive = false;
     cycleCounterActive = false;
     cv.notify_all();
-    syncCv.notify_all();
+    finishedCv.notify_all();
+    cycleBarrier.release();
+    notifyCycleWaiters();
 
-    for (auto &thread : cpuThreads)
+    for (auto &thread : workerThreads)
     {
         if (thread.joinable())
         {
             thread.join();
         }
     }
-    cpuThreads.clear();
+    workerThreads.clear();
 
     // Stop the cycle counter thread
     if (cycleCounterThread.joinable())
     {
         cycleCounterThread.join();
     }
+
+    // Parked processes go back to ready so a restart retries them
+    MemoryManager::getInstance().stopPager();
+    MemoryManager::getInstance().stopSnapshotLog();
+    while (memoryWaitCount > 0)
+    {
+        wakeMemoryWaiter(0, true);
+    }
+
+    // Every core has stopped recording, so the final flush is complete
+    tracer.stop();
 }
 
 void Scheduler::addProcess(std::shared_ptr<Process> process)
@@ -65,235 +174,571 @@ void Scheduler::addProcess(std::shared_ptr<Process> process)
     if (!process)
         return;
 
-    std::unique_lock<std::timed_mutex> lock(mutex, std::defer_lock);
-    if (!lock.try_lock_for(std::chrono::milliseconds(100)))
+    process->setArrivalCycle(cpuCycles.load());
+    ++runnableCount;
     {
-        return;
+        std::lock_guard<std::mutex> lock(weightMutex);
+        process->setCountedWeight(process->getWeight());
+        runnableWeight += process->getCountedWeight();
     }
 
-    readyQueue.push(process);
-    lock.unlock();
+    // Spread new arrivals over the cores; stealing evens out the rest
+    size_t queueIndex = nextRunQueue.fetch_add(1) % runQueues.size();
+    enqueueReady(process, queueIndex);
+}
 
-    cv.notify_all();
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+void Scheduler::reniceProcess(Process &process, int nice)
+{
+    // A runnable process takes its new weight into the sum with it
+    std::lock_guard<std::mutex> lock(weightMutex);
+    process.setNice(nice);
+    if (process.getCountedWeight() > 0)
+    {
+        runnableWeight += process.getWeight();
+        runnableWeight -= process.getCountedWeight();
+        process.setCountedWeight(process.getWeight());
+    }
 }
 
-void Scheduler::executeProcesses()
+void Scheduler::enqueueReady(std::shared_ptr<Process> process, size_t queueIndex)
 {
-    while (processingActive)
+    runQueues[queueIndex]->push(std::move(process));
+    ++readyCount;
+
+    // Taking the lock pairs the notify with idle cores' predicate check
     {
-        std::shared_ptr<Process> currentProcess = nullptr;
-        bool hasProcess = false;
+        std::lock_guard<std::timed_mutex> lock(mutex);
+    }
+    cv.notify_one();
+}
 
-        {
-            std::unique_lock<std::timed_mutex> lock(mutex);
+std::shared_ptr<Process> Scheduler::takeReady(int coreID)
+{
+    auto process = runQueues[coreID]->pop();
+
+    // Own queue is empty, try the other cores starting with the next one
+    for (size_t i = 1; !process && i < runQueues.size(); ++i)
+    {
+        process = runQueues[(coreID + i) % runQueues.size()]->steal();
+    }
+
+    if (process)
+    {
+        --readyCount;
+    }
+    return process;
+}
 
-            if (!readyQueue.empty())
+template <typename Policy>
+void Scheduler::executeProcesses(Policy policy, std::vector<Core *> ownedCores)
+{
+    while (processingActive)
+    {
+        if (!cycleBarrier.isActive())
+        {
             {
-                hasProcess = true;
+                std::unique_lock<std::timed_mutex> lock(mutex);
+                cv.wait_for(lock, std::chrono::milliseconds(100), [this]
+                            { return !processingActive || readyCount > 0 || cycleBarrier.isActive(); });
             }
-            else
+
+            // Whoever sees the work first starts the busy period for everyone
+            if (processingActive && readyCount > 0 && cycleBarrier.activate())
             {
-                hasProcess = cv.wait_for(lock, std::chrono::milliseconds(100), [this]
-                                         { return !processingActive || !readyQueue.empty(); });
+                {
+                    std::lock_guard<std::timed_mutex> lock(mutex);
+                }
+                cv.notify_all();
             }
+            continue;
+        }
 
-            if (!processingActive)
-                break;
+        // One phase: phaseLength cycles per core (always 1 in cycle mode).
+        // Cores were settled and dispatched by the serial step before it.
+        uint64_t phaseStart = cpuCycles.load();
+        uint64_t length = phaseLength.load();
+        for (Core *core : ownedCores)
+        {
+            runCore(policy, *core, phaseStart, length);
+        }
+        cycleBarrier.arriveAndWait();
+    }
 
-            if (hasProcess && !readyQueue.empty())
+    // Hand back whatever was still on our cores at shutdown
+    for (Core *core : ownedCores)
+    {
+        auto process = core->process;
+        if (process)
+        {
+            releaseCore(*core, cpuCycles.load());
+            if (!process->isFinished())
             {
-                currentProcess = getNextProcess();
+                process->markReady(cpuCycles.load());
+                process->setState(Process::READY);
+                enqueueReady(process, core->id);
             }
         }
+    }
+}
 
-        if (currentProcess)
+template <typename Policy>
+uint64_t Scheduler::scheduleAllCores(const Policy &policy, uint64_t cycle)
+{
+    // Runs between phases with every worker parked at the barrier, one core
+    // at a time in core order, so which process lands where depends only on
+    // the simulation and not on how the host threads were timed
+    uint64_t horizon = 0; // Stays 0 if every core is idle
+    for (Core &core : cores)
+    {
+        // A core whose process faulted straight away still spent the cycle
+        if (settleCore(policy, core, cycle))
         {
-            currentProcess->setState(Process::RUNNING);
-            int delays = Config::getInstance().getDelaysPerExec();
-            int currentDelay = 0;
+            uint64_t untilDecision = sliceBatching && core.process ? cyclesUntilDecision(policy, core) : 1;
+            horizon = horizon == 0 ? untilDecision : std::min(horizon, untilDecision);
+        }
+    }
+    return horizon;
+}
 
-            while (!currentProcess->isFinished() && processingActive)
-            {
-                if (Config::getInstance().getSchedulerType() == "rr" &&
-                    currentProcess->getQuantumTime() >= Config::getInstance().getQuantumCycles())
-                {
-                    updateCoreStatus(currentProcess->getCPUCoreID(), false);
-                    handleQuantumExpiration(currentProcess);
-                    break;
-                }
+template <typename Policy>
+bool Scheduler::settleCore(const Policy &policy, Core &core, uint64_t cycle)
+{
+    // Settle the previous phase's outcome before the next one
+    if (core.process && core.process->isFinished())
+    {
+        releaseCore(core, cycle);
+    }
+    else if (core.process && policy.shouldPreempt(*core.process, *runQueues[core.id]))
+    {
+        auto process = core.process;
+        releaseCore(core, cycle);
+        process->markReady(cycle);
+        handleQuantumExpiration(policy, process, core.id, cycle);
+    }
 
-                if (currentDelay < delays)
-                {
-                    currentDelay++;
-                }
-                else
-                {
-                    currentProcess->executeCurrentCommand(currentProcess->getCPUCoreID());
-                    currentProcess->moveToNextLine();
-                    currentDelay = 0;
-
-                    if (Config::getInstance().getSchedulerType() == "rr")
-                    {
-                        currentProcess->incrementQuantumTime();
-                    }
-                }
+    if (!core.process)
+    {
+        core.process = getNextProcess(policy, core.id, cycle);
+        core.currentDelay = 0;
+        if (!core.process)
+            return false;
+    }
 
-                waitForCycleSync();
-            }
+    // Outside virtual time a fault takes the process off the core again
+    if (pagingMode)
+    {
+        core.awaitingPage = false;
+        touchPage(core, cycle, true);
+    }
+    return true;
+}
 
-            {
-                std::lock_guard<std::timed_mutex> lock(mutex);
-                if (currentProcess->isFinished())
-                {
-                    MemoryManager::getInstance().releaseMemory(currentProcess->getName());
+template <typename Policy>
+uint64_t Scheduler::cyclesUntilDecision(const Policy &policy, Core &core)
+{
+    // Cycles until the process finishes, is preempted or moves to another
+    // page, any of which needs the serial step; the phase must end first
+    Process &process = *core.process;
+    uint64_t remaining = static_cast<uint64_t>(process.getLinesOfCode() - process.getCommandCounter());
+    uint64_t instructions = std::min(remaining, policy.instructionsUntilPreempt(process, *runQueues[core.id]));
+    instructions = std::max<uint64_t>(instructions, 1);
+
+    if (pagingMode)
+    {
+        int first = process.getCommandCounter();
+        uint32_t page = process.pageOfInstruction(first);
+        if (core.awaitingPage || process.getPageTable().frameOf(page) == PageTable::NOT_PRESENT)
+            return 1;
 
-                    currentProcess->setState(Process::FINISHED);
-                    finishedProcesses.push_back(currentProcess);
-                    updateCoreStatus(currentProcess->getCPUCoreID(), false);
-                }
-                else if (Config::getInstance().getSchedulerType() != "rr")
-                {
-                    currentProcess->setState(Process::READY);
-                    readyQueue.push(currentProcess);
-                }
+        uint64_t samePage = 1;
+        while (samePage < instructions && process.pageOfInstruction(first + static_cast<int>(samePage)) == page)
+        {
+            ++samePage;
+        }
+        instructions = samePage;
+    }
 
-                auto it = std::find(runningProcesses.begin(), runningProcesses.end(), currentProcess);
-                if (it != runningProcesses.end())
-                {
-                    runningProcesses.erase(it);
-                }
-            }
+    // The current instruction still has its remaining delay cycles to go
+    uint64_t cyclesPerInstruction = static_cast<uint64_t>(delaysPerExec) + 1;
+    return cyclesPerInstruction - core.currentDelay + (instructions - 1) * cyclesPerInstruction;
+}
 
-            cv.notify_all();
+template <typename Policy>
+void Scheduler::runCore(const Policy &policy, Core &core, uint64_t phaseStart, uint64_t length)
+{
+    for (uint64_t k = 0; k < length && core.process; ++k)
+    {
+        // The serial step faults pages in; one still on its way, or evicted
+        // since, waits for the next step. The pager may map it mid-phase, so
+        // awaitingPage rather than the page table says whether it is due.
+        if (core.awaitingPage || core.process->isFinished() || (pagingMode && !touchPage(core, phaseStart + k, false)))
+            break;
+
+        Process &process = *core.process;
+        if (core.currentDelay < delaysPerExec)
+        {
+            core.currentDelay++;
         }
         else
         {
-            std::this_thread::sleep_for(std::chrono::milliseconds(50));
-            cv.notify_all();
+            process.executeCurrentCommand(core.id);
+            process.moveToNextLine();
+            core.currentDelay = 0;
+            policy.onInstructionExecuted(process);
         }
     }
 }
 
-std::shared_ptr<Process> Scheduler::getNextProcess()
+bool Scheduler::touchPage(Core &core, uint64_t cycle, bool mayFault)
 {
-    if (readyQueue.empty())
+    auto &memoryManager = MemoryManager::getInstance();
+    int instruction = core.process->getCommandCounter();
+    uint32_t page = core.process->pageOfInstruction(instruction);
+    bool write = core.process->writesPage(instruction);
+
+    // Consecutive accesses to the same page add nothing to a replay
+    if (tracer.isEnabled() && (core.tracedPid != core.process->getPID() || core.tracedPage != page))
     {
-        return nullptr;
+        core.tracedPid = core.process->getPID();
+        core.tracedPage = page;
+        tracer.record(core.id, TraceEvent::PAGE_TOUCH, cycle, core.tracedPid, write ? page | PAGE_TOUCH_WRITE : page);
     }
 
-    int availableCore = -1;
-    for (size_t i = 0; i < coreStatus.size(); ++i)
+    uint32_t frame = core.process->getPageTable().frameOf(page);
+    if (frame != PageTable::NOT_PRESENT)
     {
-        if (!coreStatus[i])
+        memoryManager.markAccessed(frame, write);
+        return true;
+    }
+    if (!mayFault)
+        return false;
+
+    auto process = core.process;
+    uint64_t releaseCount = memoryManager.getReleaseCount();
+    PageRequest request;
+    auto result = memoryManager.handlePageFault(process, page, request);
+    if (result == MemoryManager::MAPPED)
+    {
+        // Mapped by a fault on another core in between, or mapped just now
+        frame = process->getPageTable().frameOf(page);
+        if (frame != PageTable::NOT_PRESENT)
         {
-            availableCore = static_cast<int>(i);
-            break;
+            memoryManager.markAccessed(frame, write);
         }
+        return true;
     }
 
-    if (availableCore == -1)
+    if (result == MemoryManager::SWAPPING)
     {
-        return nullptr;
+        if (tracer.isEnabled())
+        {
+            tracer.record(core.id, TraceEvent::PAGE_FAULT, cycle, process->getPID(), page);
+        }
+
+        ++pageWaitCount;
+
+        // In virtual time the swap costs no cycles (see waitForPageIns), so
+        // the process keeps its core and simply touches the page again next
+        // phase; sent to the back of the queue it would be evicted again
+        // before its turn came round whenever the frames are overcommitted
+        if (virtualTime)
+        {
+            deferredPageRequests.push_back(std::move(request));
+            core.awaitingPage = true;
+            return false;
+        }
+
+        // Off the core before the pager can resume it
+        releaseCore(core, cycle);
+        process->markReady(cycle);
+        process->setState(Process::WAITING);
+        memoryManager.submitPageRequest(std::move(request));
+        return false;
     }
 
-    std::shared_ptr<Process> nextProcess;
-    if (Config::getInstance().getSchedulerType() == "rr")
+    if (tracer.isEnabled())
     {
-        nextProcess = roundRobinSchedule();
+        tracer.record(core.id, TraceEvent::MEMORY_WAIT, cycle, process->getPID(), page);
     }
-    else
+
+    // Every frame is mid-swap, so wait for a release like a failed flat
+    // allocation does
+    releaseCore(core, cycle);
+    process->markReady(cycle);
+    parkForMemory(process, core.id, releaseCount);
+    return false;
+}
+
+void Scheduler::releaseCore(Core &core, uint64_t cycle)
+{
+    auto process = std::move(core.process);
+    core.process = nullptr;
+
+    std::atomic_store(&coreSlots[core.id], std::shared_ptr<Process>());
+    updateCoreStatus(core.id, false);
+
+    if (!process->isFinished())
+        return;
+
+    releaseProcessMemory(*process, core.id);
+
+    --runnableCount;
+    {
+        std::lock_guard<std::mutex> lock(weightMutex);
+        runnableWeight -= process->getCountedWeight();
+        process->setCountedWeight(0);
+    }
+    process->setFinishCycle(cycle);
+    process->setState(Process::FINISHED);
+    finishedHistory.add(ProcessSummary::of(*process));
+    process->releaseInstructions();
+
+    if (tracer.isEnabled())
     {
-        nextProcess = fcfsSchedule();
+        tracer.record(core.id, TraceEvent::FINISH, cycle, process->getPID(), process->getLinesOfCode());
+    }
+
+    uint64_t response = process->getFirstRunCycle() - process->getArrivalCycle();
+    uint64_t turnaround = cycle - process->getArrivalCycle();
+    responseTimes.record(response);
+    waitingTimes.record(process->getWaitingCycles());
+    turnaroundTimes.record(turnaround);
+
+    auto &stats = levelStats[std::min<size_t>(process->getPriorityLevel(), numLevels - 1)];
+    stats.finished++;
+    stats.totalResponse += response;
+    stats.totalTurnaround += turnaround;
+
+    // Counted under the lock so waitForFinished cannot miss the notify
+    {
+        std::lock_guard<std::timed_mutex> lock(mutex);
+        ++finishedCount;
+    }
+    finishedCv.notify_all();
+}
+
+template <typename Policy>
+std::shared_ptr<Process> Scheduler::getNextProcess(const Policy &policy, int coreID, uint64_t cycle)
+{
+    if (readyCount == 0)
+    {
+        return nullptr;
+    }
+
+    std::shared_ptr<Process> nextProcess = takeReady(coreID);
+    if (nextProcess && policy.shouldPreempt(*nextProcess, *runQueues[coreID]))
+    {
+        handleQuantumExpiration(policy, nextProcess, coreID, cycle);
+        nextProcess = takeReady(coreID);
     }
 
     if (nextProcess)
     {
-        if (!MemoryManager::getInstance().allocateMemory(nextProcess))
+        auto &memoryManager = MemoryManager::getInstance();
+        uint64_t releaseCount = memoryManager.getReleaseCount();
+        if (!memoryManager.allocateMemory(nextProcess))
         {
-            // If allocation fails, put back in ready queue
-            readyQueue.push(nextProcess);
+            if (tracer.isEnabled())
+            {
+                tracer.record(coreID, TraceEvent::ALLOC_FAIL, cycle, nextProcess->getPID(), nextProcess->getMemorySize());
+            }
+
+            // Park it until a block is freed instead of retrying every cycle
+            parkForMemory(nextProcess, coreID, releaseCount);
             return nullptr;
         }
-        nextProcess->setCPUCoreID(availableCore);
-        coreStatus[availableCore] = true;
-        runningProcesses.push_back(nextProcess);
+
+        if (tracer.isEnabled())
+        {
+            tracer.record(coreID, TraceEvent::DISPATCH, cycle, nextProcess->getPID(), nextProcess->getPriorityLevel());
+        }
+        nextProcess->recordDispatch(cycle);
+        ++contextSwitches;
+        nextProcess->setState(Process::RUNNING);
+        nextProcess->setCPUCoreID(coreID);
+        coreStatus[coreID] = true;
+        std::atomic_store(&coreSlots[coreID], nextProcess);
     }
 
     return nextProcess;
 }
 
-std::shared_ptr<Process> Scheduler::fcfsSchedule()
+template <typename Policy>
+void Scheduler::handleQuantumExpiration(const Policy &policy, std::shared_ptr<Process> process, int coreID, uint64_t cycle)
 {
-    if (readyQueue.empty())
+    // Resident pages stay mapped across a preemption
+    if (!pagingMode)
     {
-        return nullptr;
+        releaseProcessMemory(*process, coreID);
     }
 
-    auto process = readyQueue.front();
-    readyQueue.pop();
-    return process;
+    policy.onPreempt(*process);
+    if (tracer.isEnabled())
+    {
+        tracer.record(coreID, TraceEvent::PREEMPT, cycle, process->getPID(), process->getPriorityLevel());
+    }
+    process->setState(Process::READY);
+    enqueueReady(process, coreID);
 }
 
-std::shared_ptr<Process> Scheduler::roundRobinSchedule()
+void Scheduler::parkForMemory(std::shared_ptr<Process> process, int coreID, uint64_t releaseCount)
 {
-    if (readyQueue.empty())
-        return nullptr;
+    process->setState(Process::WAITING);
+    {
+        std::lock_guard<std::mutex> lock(memoryWaitMutex);
+        memoryWaitQueue.push_back(std::move(process));
+        ++memoryWaitCount;
+    }
+
+    // A block freed after our failed attempt but before the push above
+    // found nobody to wake, so take that wakeup ourselves
+    if (MemoryManager::getInstance().getReleaseCount() != releaseCount)
+    {
+        wakeMemoryWaiter(coreID);
+    }
+}
 
-    auto process = readyQueue.front();
-    readyQueue.pop();
+void Scheduler::releaseProcessMemory(Process &process, int coreID)
+{
+    // A freed block is at least as big as the waiter it can let in
+    if (MemoryManager::getInstance().releaseMemory(process))
+    {
+        wakeMemoryWaiter(coreID);
+    }
+}
 
-    if (isQuantumExpired(process))
+void Scheduler::wakeMemoryWaiter(int coreID, bool anyWaiter)
+{
+    // In flat mode the oldest waiter that fits the largest free block goes
+    // first, so one that is too big cannot hold up the others. If none fits,
+    // compaction is asked to make room for the oldest.
+    auto &memoryManager = MemoryManager::getInstance();
+    size_t largestFree = anyWaiter || pagingMode ? SIZE_MAX : memoryManager.getLargestFreeBlock();
+    size_t compactFor = 0;
+
+    std::shared_ptr<Process> process;
     {
-        handleQuantumExpiration(process);
+        std::lock_guard<std::mutex> lock(memoryWaitMutex);
+        if (memoryWaitQueue.empty())
+            return;
 
-        if (!readyQueue.empty())
+        auto fits = std::find_if(memoryWaitQueue.begin(), memoryWaitQueue.end(),
+                                 [largestFree](const std::shared_ptr<Process> &waiter)
+                                 { return waiter->getMemorySize() <= largestFree; });
+        if (fits == memoryWaitQueue.end())
         {
-            process = readyQueue.front();
-            readyQueue.pop();
+            compactFor = memoryWaitQueue.front()->getMemorySize();
         }
         else
         {
-            return nullptr;
+            process = std::move(*fits);
+            memoryWaitQueue.erase(fits);
+            --memoryWaitCount;
         }
     }
 
-    return process;
+    if (!process)
+    {
+        memoryManager.requestCompaction(compactFor);
+        return;
+    }
+
+    process->setState(Process::READY);
+    enqueueReady(process, coreID);
 }
 
-bool Scheduler::isQuantumExpired(const std::shared_ptr<Process> &process) const
+void Scheduler::resumeAfterPageIn(std::shared_ptr<Process> process)
 {
-    return process->getQuantumTime() >= Config::getInstance().getQuantumCycles();
+    // In virtual time it never left its core
+    if (!virtualTime)
+    {
+        process->setState(Process::READY);
+        enqueueReady(process, std::max(0, process->getCPUCoreID()) % runQueues.size());
+    }
+
+    // Back in the queue before it stops counting, for waitForPageIns
+    {
+        std::lock_guard<std::timed_mutex> lock(mutex);
+        --pageWaitCount;
+    }
+    cv.notify_all();
 }
 
-void Scheduler::handleQuantumExpiration(std::shared_ptr<Process> process)
+void Scheduler::waitForPageIns()
 {
-    MemoryManager::getInstance().releaseMemory(process->getName());
+    // In virtual time a swap takes no cycles: every page requested during a
+    // phase is mapped before the next one is scheduled, so the pager's
+    // wall-clock speed cannot change the simulation
+    if (!virtualTime)
+        return;
 
-    process->resetQuantumTime();
-    process->setState(Process::READY);
-    readyQueue.push(process);
+    std::unique_lock<std::timed_mutex> lock(mutex);
+    cv.wait(lock, [this]
+            { return pageWaitCount == 0 || !processingActive; });
 }
 
-void Scheduler::getCPUUtilization() const
+void Scheduler::writeFinishedProcesses(std::ostream &out, size_t page) const
 {
-    std::stringstream report;
-    int totalCores;
-    int usedCores;
-    std::vector<std::shared_ptr<Process>> runningProcessesCopy;
-    std::vector<std::shared_ptr<Process>> finishedProcessesCopy;
+    std::vector<ProcessSummary> summaries;
+    if (page == 0)
+    {
+        summaries = finishedHistory.recent();
+        out << "Finished processes:\n";
+        if (summaries.size() < finishedHistory.size())
+        {
+            out << "(last " << summaries.size() << " of " << finishedHistory.size()
+                << ", add a page number to see older ones)\n";
+        }
+    }
+    else
+    {
+        size_t pages = (finishedHistory.size() + FINISHED_PAGE_SIZE - 1) / FINISHED_PAGE_SIZE;
+        summaries = finishedHistory.read((page - 1) * FINISHED_PAGE_SIZE, FINISHED_PAGE_SIZE);
+        out << "Finished processes (page " << page << " of " << pages << ", oldest first):\n";
+    }
 
+    for (const auto &summary : summaries)
     {
-        std::lock_guard<std::timed_mutex> lock(mutex);
-        totalCores = Config::getInstance().getNumCPU();
-        usedCores = runningProcesses.size();
-        runningProcessesCopy = runningProcesses;
-        finishedProcessesCopy = finishedProcesses;
+        out << summary.getName()
+            << " (" << formatTimestamp(summary.getCreationTime()) << ")   "
+            << "Finished    "
+            << summary.linesOfCode << " / " << summary.linesOfCode << "\n";
     }
+}
+
+std::vector<std::shared_ptr<Process>> Scheduler::getRunningProcesses() const
+{
+    std::vector<std::shared_ptr<Process>> running;
+    for (const auto &slot : coreSlots)
+    {
+        auto process = std::atomic_load(&slot);
+        if (process)
+        {
+            running.push_back(std::move(process));
+        }
+    }
+    return running;
+}
+
+void Scheduler::getCPUUtilization(size_t page) const
+{
+    std::stringstream report;
+    int totalCores = Config::getInstance().getNumCPU();
+    auto runningProcessesCopy = getRunningProcesses();
+    int usedCores = runningProcessesCopy.size();
 
     report << "CPU utilization: " << (usedCores * 100 / totalCores) << "%\n";
     report << "Cores used: " << usedCores << "\n";
-    report << "Cores available: " << (totalCores - usedCores) << "\n\n";
+    report << "Cores available: " << (totalCores - usedCores) << "\n";
+    if (memoryWaitCount > 0)
+    {
+        report << "Waiting for memory: " << memoryWaitCount << "\n";
+    }
+    if (pageWaitCount > 0)
+    {
+        report << "Waiting for swap-in: " << pageWaitCount << "\n";
+    }
+    report << "\n";
 
     report << "Running processes:\n";
     for (const auto &process : runningProcessesCopy)
@@ -304,13 +749,29 @@ void Scheduler::getCPUUtilization() const
                << process->getCommandCounter() << " / " << process->getLinesOfCode() << "\n";
     }
 
-    report << "\nFinished processes:\n";
-    for (const auto &process : finishedProcessesCopy)
+    report << "\n";
+    writeFinishedProcesses(report, page);
+
+    if (turnaroundTimes.getCount() > 0)
     {
-        report << process->getName()
-               << " (" << formatTimestamp(std::chrono::system_clock::now()) << ")   "
-               << "Finished    "
-               << process->getLinesOfCode() << " / " << process->getLinesOfCode() << "\n";
+        report << "\n";
+        writeLatencyReport(report);
+    }
+
+    if (Config::getInstance().getSchedulerPolicy() == Config::MLFQ)
+    {
+        report << "\nMLFQ levels (by level at finish, in cycles):\n";
+        for (size_t level = 0; level < numLevels; ++level)
+        {
+            uint64_t levelFinished = levelStats[level].finished.load();
+            report << "Level " << level << ": " << levelFinished << " finished";
+            if (levelFinished > 0)
+            {
+                report << "    avg response " << levelStats[level].totalResponse.load() / levelFinished
+                       << "    avg turnaround " << levelStats[level].totalTurnaround.load() / levelFinished;
+            }
+            report << "\n";
+        }
     }
 
     std::cout << report.str();
@@ -324,74 +785,131 @@ void Scheduler::getCPUUtilization() const
     }
 }
 
-void Scheduler::waitForCycleSync()
+void Scheduler::writeLatencyReport(std::ostream &out) const
+{
+    out << "Latency (cycles)     count      mean       p50       p90       p99       max\n";
+
+    auto writeRow = [&out](const char *label, const LatencyHistogram &histogram)
+    {
+        auto summary = histogram.summarize();
+        out << std::left << std::setw(16) << label << std::right
+            << std::setw(10) << summary.count
+            << std::setw(10) << summary.mean
+            << std::setw(10) << summary.p50
+            << std::setw(10) << summary.p90
+            << std::setw(10) << summary.p99
+            << std::setw(10) << summary.max << "\n";
+    };
+    writeRow("Response", responseTimes);
+    writeRow("Waiting", waitingTimes);
+    writeRow("Turnaround", turnaroundTimes);
+}
+
+void Scheduler::printLatencyStatistics() const
+{
+    if (turnaroundTimes.getCount() == 0)
+    {
+        std::cout << "No processes have finished yet.\n";
+        return;
+    }
+
+    std::ostringstream report;
+    writeLatencyReport(report);
+    std::cout << report.str();
+}
+
+bool Scheduler::beginPhase()
+{
+    waitForClockHolders();
+    waitForPageIns();
+    uint64_t horizon = scheduleCores(cpuCycles.load());
+    decisionHorizon = horizon;
+
+    // Held back until every core has faulted, so the pager cannot change
+    // the frames later cores pick their victims from
+    for (auto &request : deferredPageRequests)
+    {
+        MemoryManager::getInstance().submitPageRequest(std::move(request));
+    }
+    deferredPageRequests.clear();
+    phaseLength = computePhaseLength();
+
+    // Compaction only advances with the clock, so it keeps the cores going
+    return horizon > 0 || MemoryManager::getInstance().isCompacting();
+}
+
+bool Scheduler::completeCycle()
 {
     const int CYCLE_SPEED = 1000; // Base timing in microseconds
-    const int CYCLE_WAIT = 1000;
 
-    try
+    // Runs once per phase, on whichever worker arrived last at the barrier
+    uint64_t length = phaseLength.load();
+    incrementCPUCycles(length);
+    generateMemorySnapshotIfNeeded();
+
+    auto &memoryManager = MemoryManager::getInstance();
+    if (memoryManager.isCompacting() && memoryManager.compactStep(length))
     {
-        std::unique_lock<std::timed_mutex> syncLock(syncMutex);
-        std::this_thread::sleep_for(std::chrono::microseconds(CYCLE_SPEED));
+        wakeMemoryWaiter(0);
+    }
 
-        int runningCount;
-        {
-            std::unique_lock<std::timed_mutex> lock(mutex);
-            runningCount = runningProcesses.size();
-        }
+    if (boostInterval > 0 && cpuCycles.load() % boostInterval == 0)
+    {
+        boostPriorities();
+    }
 
-        if (runningCount == 0)
-        {
-            incrementCPUCycles();
+    bool busy = beginPhase();
+    pace(CYCLE_SPEED * static_cast<int>(length));
+    return busy;
+}
 
-            generateMemorySnapshotIfNeeded();
+uint64_t Scheduler::computePhaseLength() const
+{
+    // Cycle mode phases are a single cycle, so they cannot overshoot a
+    // clock waiter's target either
+    if (!sliceBatching)
+        return 1;
 
-            std::this_thread::sleep_for(std::chrono::microseconds(CYCLE_WAIT));
-            return;
-        }
+    // A whole quantum at most, ending early at the next timed event
+    uint64_t now = cpuCycles.load();
+    uint64_t length = snapshotInterval;
 
-        try
-        {
-            coresWaiting++;
-            if (coresWaiting >= runningCount)
-            {
-                incrementCPUCycles();
-                coresWaiting = 0;
-                syncCv.notify_all();
-                generateMemorySnapshotIfNeeded();
-                std::this_thread::sleep_for(std::chrono::microseconds(CYCLE_WAIT));
-            }
-            else
-            {
-                syncCv.wait_for(syncLock,
-                                std::chrono::microseconds(CYCLE_WAIT),
-                                [this]
-                                { return coresWaiting == 0; });
+    uint64_t nextSnapshot = static_cast<uint64_t>(lastMemorySnapshotCycle) + snapshotInterval;
+    if (memorySnapshots && nextSnapshot > now)
+    {
+        length = std::min(length, nextSnapshot - now);
+    }
 
-                std::this_thread::sleep_for(std::chrono::microseconds(CYCLE_SPEED));
+    if (boostInterval > 0)
+    {
+        length = std::min<uint64_t>(length, boostInterval - now % boostInterval);
+    }
 
-                if (coresWaiting > 0)
-                {
-                    coresWaiting = 0;
-                    incrementCPUCycles();
-                    syncCv.notify_all();
-                    generateMemorySnapshotIfNeeded();
-                }
-            }
-        }
-        catch (...)
-        {
-            if (coresWaiting > 0)
-            {
-                coresWaiting--;
-            }
-            std::this_thread::sleep_for(std::chrono::microseconds(CYCLE_SPEED));
-            throw;
-        }
+    uint64_t nextWake = nextWakeCycle.load();
+    if (nextWake > now)
+    {
+        length = std::min(length, nextWake - now);
+    }
+
+    if (decisionHorizon > 0)
+    {
+        length = std::min(length, decisionHorizon);
+    }
+
+    return std::max<uint64_t>(length, 1);
+}
+
+void Scheduler::boostPriorities()
+{
+    for (auto &runQueue : runQueues)
+    {
+        runQueue->boost();
     }
-    catch (...)
+
+    // Running processes keep their core but return to the top level
+    for (auto &process : getRunningProcesses())
     {
-        std::this_thread::sleep_for(std::chrono::microseconds(CYCLE_SPEED));
+        process->setPriorityLevel(0);
     }
 }
 
@@ -409,31 +927,152 @@ void Scheduler::updateCoreStatus(int coreID, bool active)
 
 void Scheduler::cycleCounterLoop()
 {
+    auto stopped = [this]
+    { return !cycleCounterActive; };
+
     while (cycleCounterActive)
     {
-        bool shouldSleep = false;
+        // Busy workers drive the clock themselves; sleep until they go idle
+        cycleBarrier.waitUntilIdle(stopped);
+        if (!cycleCounterActive)
+            break;
+
+        // Something is about to be dispatched, give the workers a chance to start
+        if (readyCount > 0)
         {
-            std::unique_lock<std::timed_mutex> lock(syncMutex);
-            if (runningProcesses.empty() && readyQueue.empty())
-            {
-                incrementCPUCycles();
-                shouldSleep = true;
-            }
+            cycleBarrier.waitWhileIdle(std::chrono::milliseconds(50), stopped);
+            continue;
         }
 
-        if (shouldSleep)
+        if (virtualTime)
         {
-            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            advanceIdleClock();
+            continue;
         }
+
+        // Idle cycles tick on a timer; a busy period starting cuts the wait short
+        if (cycleBarrier.waitWhileIdle(std::chrono::milliseconds(50), stopped))
+        {
+            cycleBarrier.runIfIdle([this]
+                                   {
+                if (readyCount == 0 && nextWakeCycle.load() > cpuCycles.load())
+                {
+                    incrementCPUCycles();
+                } });
+        }
+    }
+}
+
+void Scheduler::advanceIdleClock()
+{
+    {
+        std::unique_lock<std::mutex> lock(clockMutex);
+
+        // Nothing observable happens while idle until a waiter's cycle lies ahead
+        clockCv.wait(lock, [this]
+                     { return !cycleCounterActive || (nextWakeCycle.load() != UINT64_MAX && nextWakeCycle.load() > cpuCycles.load()); });
+    }
+
+    // Jump under the barrier lock so no worker can start a phase meanwhile
+    cycleBarrier.runIfIdle([this]
+                           {
+        uint64_t target = nextWakeCycle.load();
+        uint64_t current = cpuCycles.load();
+        if (cycleCounterActive && readyCount == 0 && target != UINT64_MAX && current < target)
+        {
+            incrementCPUCycles(target - current);
+        } });
+}
+
+void Scheduler::incrementCPUCycles(uint64_t cycles)
+{
+    uint64_t now = cpuCycles += cycles;
+
+    if (now >= nextWakeCycle.load())
+    {
+        std::lock_guard<std::mutex> lock(clockMutex);
+        clockCv.notify_all();
+    }
+}
+
+void Scheduler::waitForCycle(uint64_t targetCycle, const std::atomic<bool> &active)
+{
+    std::unique_lock<std::mutex> lock(clockMutex);
+
+    // Replaces this thread's previous hold, letting the clock move past it
+    clockHolds[std::this_thread::get_id()] = targetCycle;
+    updateNextWakeCycle();
+    clockCv.notify_all();
+
+    clockCv.wait(lock, [&]
+                 { return cpuCycles.load() >= targetCycle || !active || !processingActive; });
+
+    // Stopping, so nothing will be done at the target
+    if (!active || !processingActive)
+    {
+        clockHolds.erase(std::this_thread::get_id());
+        updateNextWakeCycle();
+        clockCv.notify_all();
+    }
+}
+
+void Scheduler::releaseCycle()
+{
+    std::lock_guard<std::mutex> lock(clockMutex);
+    if (clockHolds.erase(std::this_thread::get_id()) > 0)
+    {
+        updateNextWakeCycle();
+        clockCv.notify_all();
+    }
+}
+
+void Scheduler::updateNextWakeCycle()
+{
+    uint64_t earliest = UINT64_MAX;
+    for (const auto &hold : clockHolds)
+    {
+        earliest = std::min(earliest, hold.second);
+    }
+    nextWakeCycle = earliest;
+}
+
+void Scheduler::waitForClockHolders()
+{
+    // A waiter whose cycle has come is still acting on it; the next phase
+    // starts once it has moved its hold on
+    std::unique_lock<std::mutex> lock(clockMutex);
+    clockCv.wait(lock, [this]
+                 { return nextWakeCycle.load() > cpuCycles.load() || !processingActive; });
+}
+
+void Scheduler::waitForFinished(uint64_t count)
+{
+    std::unique_lock<std::timed_mutex> lock(mutex);
+    finishedCv.wait(lock, [this, count]
+                    { return finishedCount.load() >= count || !processingActive; });
+}
+
+void Scheduler::notifyCycleWaiters()
+{
+    std::lock_guard<std::mutex> lock(clockMutex);
+    clockCv.notify_all();
+}
+
+void Scheduler::pace(int microseconds) const
+{
+    if (!virtualTime)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(microseconds));
     }
 }
 
 void Scheduler::generateMemorySnapshotIfNeeded()
 {
-    uint32_t currentCycle = static_cast<uint32_t>(cpuCycles.load());
-    uint32_t quantumCycles = Config::getInstance().getQuantumCycles();
+    if (!memorySnapshots)
+        return;
 
-    if (currentCycle >= lastMemorySnapshotCycle + quantumCycles)
+    uint32_t currentCycle = static_cast<uint32_t>(cpuCycles.load());
+    if (currentCycle >= lastMemorySnapshotCycle + snapshotInterval)
     {
         MemoryManager::getInstance().generateMemorySnapshot(currentCycle);
         lastMemorySnapshotCycle = currentCycle;
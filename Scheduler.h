@@ -1,15 +1,26 @@
 #ifndef SCHEDULER_H
 #define SCHEDULER_H
 
-#include <queue>
 #include <thread>
 #include <memory>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
 #include <vector>
+#include <deque>
+#include <map>
+#include <array>
+#include <functional>
+#include <ostream>
 #include "Process.h"
 #include "Config.h"
+#include "RunQueue.h"
+#include "CycleBarrier.h"
+#include "SchedulerPolicy.h"
+#include "LatencyHistogram.h"
+#include "Tracer.h"
+#include "FinishedHistory.h"
+#include "Pager.h"
 
 class Scheduler
 {
@@ -26,45 +37,180 @@ public:
     void addProcess(std::shared_ptr<Process> process);
     void startScheduling();
     void stopScheduling();
-    void getCPUUtilization() const;
+    void resumeAfterPageIn(std::shared_ptr<Process> process); // Called by the pager
+    void reniceProcess(Process &process, int nice);
+    // page 0 lists the finished processes still in memory; page n >= 1
+    // pages through every finished process, oldest first, archive included
+    void getCPUUtilization(size_t page = 0) const;
+    std::vector<std::shared_ptr<Process>> getRunningProcesses() const;
+    const FinishedHistory &getFinishedHistory() const { return finishedHistory; }
+    void writeFinishedProcesses(std::ostream &out, size_t page) const;
+    static constexpr size_t FINISHED_PAGE_SIZE = 50;
+    void printLatencyStatistics() const;
     uint64_t getCPUCycles() const { return cpuCycles.load(); }
 
+    // Blocks until the clock reaches targetCycle or active turns false. The
+    // clock then holds at targetCycle until the caller waits for a later
+    // cycle or calls releaseCycle, so whatever it does on waking (adding a
+    // process) lands on exactly that cycle. In virtual time an idle clock
+    // jumps straight to the earliest target.
+    void waitForCycle(uint64_t targetCycle, const std::atomic<bool> &active);
+    void releaseCycle();
+    void notifyCycleWaiters();
+
+    // Run statistics, used by the benchmark harness
+    uint64_t getContextSwitches() const { return contextSwitches.load(); }
+    uint64_t getTraceDroppedRecords() const { return tracer.getDroppedRecords(); }
+    uint64_t getFinishedCount() const { return finishedCount.load(); }
+    void waitForFinished(uint64_t count);
+
 private:
     Scheduler();
     ~Scheduler() { stopScheduling(); }
 
     std::atomic<bool> isInitialized{false};
 
-    // Process queues
-    std::queue<std::shared_ptr<Process>> readyQueue;
-    std::vector<std::shared_ptr<Process>> runningProcesses;
-    std::vector<std::shared_ptr<Process>> finishedProcesses;
+    // Process queues (one ready queue per core, idle cores steal)
+    std::vector<std::unique_ptr<RunQueue>> runQueues;
+    std::atomic<size_t> readyCount{0};
+    std::atomic<size_t> runnableCount{0}; // Added and not yet finished
+    std::atomic<uint64_t> runnableWeight{0}; // Their CFS weights, for time slices
+    std::mutex weightMutex;                  // Orders renice against add and finish
+    std::atomic<uint64_t> finishedCount{0};
+    std::atomic<uint64_t> contextSwitches{0};
+    std::condition_variable_any finishedCv;
+    std::atomic<size_t> nextRunQueue{0};
+
+    // Published for reporting: slot i holds what core i is running (read and
+    // written with std::atomic_load/atomic_store). Finished processes are
+    // kept only as summaries. Readers never take the scheduler mutex.
+    std::vector<std::shared_ptr<Process>> coreSlots;
+    FinishedHistory finishedHistory;
+
+    // Processes that failed to get memory, woken in FIFO order one per freed
+    // block. They are not in the ready queues while parked.
+    std::mutex memoryWaitMutex;
+    std::deque<std::shared_ptr<Process>> memoryWaitQueue;
+    std::atomic<size_t> memoryWaitCount{0};
+    std::atomic<size_t> pageWaitCount{0}; // Parked on the pager
+    std::vector<PageRequest> deferredPageRequests; // Virtual time: faults of the current scheduling step
 
     // Synchronization with timed mutexes
     mutable std::timed_mutex mutex;
-    mutable std::timed_mutex syncMutex;
     std::condition_variable_any cv;
-    std::condition_variable_any syncCv;
-    std::atomic<int> coresWaiting{0};
     std::atomic<bool> processingActive{false};
 
+    // While any core is busy, every worker meets here once per phase; the
+    // completion step advances the clock and schedules the next phase
+    CycleBarrier cycleBarrier;
+
+    // A simulated CPU. The host worker that owns it touches these fields
+    // during a phase, the serial scheduling step between phases.
+    struct Core
+    {
+        int id{0};
+        std::shared_ptr<Process> process;
+        uint32_t currentDelay{0};
+        bool awaitingPage{false}; // Virtual time: faulted, the pager finishes by the next step
+        int tracedPid{0}; // Last PAGE_TOUCH recorded
+        uint32_t tracedPage{0};
+    };
+
     // CPU management
-    std::vector<std::thread> cpuThreads;
-    std::vector<bool> coreStatus;
+    std::vector<Core> cores;
+    std::vector<std::thread> workerThreads;
+    std::vector<std::atomic<bool>> coreStatus;
     std::atomic<uint64_t> cpuCycles{0};
     std::thread cycleCounterThread;
     std::atomic<bool> cycleCounterActive{false};
 
-    // Core methods
-    void executeProcesses();
-    std::shared_ptr<Process> getNextProcess();
-    std::shared_ptr<Process> roundRobinSchedule();
-    std::shared_ptr<Process> fcfsSchedule();
-    void handleQuantumExpiration(std::shared_ptr<Process> process);
-    bool isQuantumExpired(const std::shared_ptr<Process> &process) const;
+    // Virtual time drops all wall-clock pacing; cycles advance as fast as
+    // the cores execute and idle time is skipped to the next waiter
+    bool virtualTime{false};
+    std::mutex clockMutex;
+    std::condition_variable clockCv;
+    std::map<std::thread::id, uint64_t> clockHolds; // Target per waiting thread, under clockMutex
+    std::atomic<uint64_t> nextWakeCycle{UINT64_MAX}; // Earliest hold
+    void updateNextWakeCycle();
+    void waitForClockHolders();
+
+    // Settings read once in startScheduling so the hot loop never touches Config
+    uint32_t delaysPerExec{0};
+    uint32_t snapshotInterval{1};
+    uint32_t boostInterval{0};
+    bool memorySnapshots{true};
+    bool pagingMode{false};
+
+    // Binary event trace, only recorded when trace-file is set
+    Tracer tracer;
+
+    // In slice mode every core runs phaseLength cycles between barrier
+    // syncs; the length is cut short at the next snapshot, boost or clock
+    // waiter so those still land on their exact cycle, and at the first
+    // core that needs a scheduling decision (decisionHorizon cycles away)
+    bool sliceBatching{false};
+    std::atomic<uint64_t> phaseLength{1};
+    uint64_t decisionHorizon{0};
+
+    // Finished-process latency, grouped by the MLFQ level a process finished
+    // in (every other policy has a single level)
+    static constexpr size_t MAX_LEVELS = 8; // Config caps mlfq-levels at 8
+    struct LevelStatistics
+    {
+        std::atomic<uint64_t> finished{0};
+        std::atomic<uint64_t> totalResponse{0};
+        std::atomic<uint64_t> totalTurnaround{0};
+    };
+    std::array<LevelStatistics, MAX_LEVELS> levelStats;
+    size_t numLevels{1};
+
+    // Distributions over all finished processes; lock-free to record and read
+    LatencyHistogram responseTimes;
+    LatencyHistogram waitingTimes;
+    LatencyHistogram turnaroundTimes;
+    void writeLatencyReport(std::ostream &out) const;
+
+    // Core methods, instantiated once per scheduling policy
+    template <typename Policy>
+    void startCores(const Policy &policy);
+    template <typename Policy>
+    void executeProcesses(Policy policy, std::vector<Core *> ownedCores);
+    // Settles and dispatches every core in core order for the phase
+    // starting at cycle. Returns cycles until the first core needs another
+    // decision (1 in cycle mode), or 0 if every core is idle.
+    std::function<uint64_t(uint64_t)> scheduleCores;
+    template <typename Policy>
+    uint64_t scheduleAllCores(const Policy &policy, uint64_t cycle);
+    template <typename Policy>
+    bool settleCore(const Policy &policy, Core &core, uint64_t cycle); // False if the core stays idle
+    template <typename Policy>
+    uint64_t cyclesUntilDecision(const Policy &policy, Core &core);
+    template <typename Policy>
+    void runCore(const Policy &policy, Core &core, uint64_t phaseStart, uint64_t length);
+    void releaseCore(Core &core, uint64_t cycle);
+    // Paging mode: faults in the page the next instruction touches. False if
+    // the process left the core to wait for it, or, without mayFault, if the
+    // page is not resident.
+    bool touchPage(Core &core, uint64_t cycle, bool mayFault);
+    template <typename Policy>
+    std::shared_ptr<Process> getNextProcess(const Policy &policy, int coreID, uint64_t cycle);
+    template <typename Policy>
+    void handleQuantumExpiration(const Policy &policy, std::shared_ptr<Process> process, int coreID, uint64_t cycle);
+
+    void enqueueReady(std::shared_ptr<Process> process, size_t queueIndex);
+    void parkForMemory(std::shared_ptr<Process> process, int coreID, uint64_t releaseCount);
+    void releaseProcessMemory(Process &process, int coreID);
+    void wakeMemoryWaiter(int coreID, bool anyWaiter = false); // anyWaiter: skip the fit check, for shutdown
+    void waitForPageIns();
+    std::shared_ptr<Process> takeReady(int coreID);
     void updateCoreStatus(int coreID, bool active);
-    void incrementCPUCycles() { ++cpuCycles; }
-    void waitForCycleSync();
+    void incrementCPUCycles(uint64_t cycles = 1);
+    uint64_t computePhaseLength() const;
+    void advanceIdleClock();
+    void pace(int microseconds) const;
+    bool beginPhase();    // Barrier activation: false if there is nothing to run
+    bool completeCycle(); // Barrier completion: false ends the busy period
+    void boostPriorities();
     void cycleCounterLoop();
 
     uint32_t lastMemorySnapshotCycle{0};
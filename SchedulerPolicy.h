@@ -0,0 +1,179 @@
+#ifndef SCHEDULER_POLICY_H
+#define SCHEDULER_POLICY_H
+
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include "Config.h"
+#include "Process.h"
+#include "RunQueue.h"
+
+// Scheduling policies for Scheduler::executeProcesses<Policy>. The policy is
+// picked once in startScheduling and copied into every core thread, so the
+// per-instruction loop is compiled for one policy with all config values it
+// needs already captured.
+//
+// A policy provides:
+//   ordering                       - how the per-core RunQueues are keyed
+//   shouldPreempt(process, queue)  - checked before every executed cycle,
+//                                    queue is the executing core's RunQueue
+//   onInstructionExecuted(process) - after each instruction completes
+//   onPreempt(process)             - when the process is sent back to ready
+//   instructionsUntilPreempt(process, queue)
+//                                  - how many more instructions can run before
+//                                    shouldPreempt turns true, assuming the
+//                                    queue does not change meanwhile; lets
+//                                    slice mode end a phase right there
+
+struct FCFSPolicy
+{
+    explicit FCFSPolicy(const Config &) {}
+
+    static constexpr RunQueue::Ordering ordering = RunQueue::BY_LEVEL;
+
+    bool shouldPreempt(Process &, const RunQueue &) const { return false; }
+    void onInstructionExecuted(Process &) const {}
+    void onPreempt(Process &) const {}
+    uint64_t instructionsUntilPreempt(const Process &, const RunQueue &) const { return UINT64_MAX; }
+};
+
+struct RoundRobinPolicy
+{
+    explicit RoundRobinPolicy(const Config &config)
+        : quantumCycles(config.getQuantumCycles()) {}
+
+    static constexpr RunQueue::Ordering ordering = RunQueue::BY_LEVEL;
+
+    bool shouldPreempt(Process &process, const RunQueue &) const { return process.getQuantumTime() >= quantumCycles; }
+    void onInstructionExecuted(Process &process) const { process.incrementQuantumTime(); }
+    void onPreempt(Process &process) const { process.resetQuantumTime(); }
+
+    uint64_t instructionsUntilPreempt(const Process &process, const RunQueue &) const
+    {
+        return quantumCycles - std::min<uint64_t>(process.getQuantumTime(), quantumCycles);
+    }
+
+    uint32_t quantumCycles;
+};
+
+// Multi-level feedback queue: a process that burns its whole quantum drops
+// one level, and deeper levels get longer quanta. Levels map onto the
+// RunQueue keys; the periodic boost lives in the Scheduler.
+struct MLFQPolicy
+{
+    explicit MLFQPolicy(const Config &config)
+        : quanta(config.getMLFQQuanta()) {}
+
+    static constexpr RunQueue::Ordering ordering = RunQueue::BY_LEVEL;
+
+    uint32_t quantumOf(const Process &process) const
+    {
+        return quanta[std::min<size_t>(process.getPriorityLevel(), quanta.size() - 1)];
+    }
+
+    bool shouldPreempt(Process &process, const RunQueue &) const { return process.getQuantumTime() >= quantumOf(process); }
+
+    void onInstructionExecuted(Process &process) const { process.incrementQuantumTime(); }
+
+    void onPreempt(Process &process) const
+    {
+        if (process.getPriorityLevel() + 1 < quanta.size())
+        {
+            process.setPriorityLevel(process.getPriorityLevel() + 1);
+        }
+        process.resetQuantumTime();
+    }
+
+    uint64_t instructionsUntilPreempt(const Process &process, const RunQueue &) const
+    {
+        return quantumOf(process) - std::min<uint64_t>(process.getQuantumTime(), quantumOf(process));
+    }
+
+    std::vector<uint32_t> quanta;
+};
+
+// Shortest job first. Both variants order the ready queues by remaining
+// instructions, which Process knows exactly. SJF runs the picked process to
+// completion; SRTF preempts as soon as the core's own queue holds a process
+// with less work left. Other cores' queues are not consulted, so with
+// several cores this is per-core SRTF with stealing to balance the load.
+struct SJFPolicy
+{
+    explicit SJFPolicy(const Config &) {}
+
+    static constexpr RunQueue::Ordering ordering = RunQueue::BY_REMAINING;
+
+    bool shouldPreempt(Process &, const RunQueue &) const { return false; }
+    void onInstructionExecuted(Process &) const {}
+    void onPreempt(Process &) const {}
+    uint64_t instructionsUntilPreempt(const Process &, const RunQueue &) const { return UINT64_MAX; }
+};
+
+struct SRTFPolicy
+{
+    explicit SRTFPolicy(const Config &) {}
+
+    static constexpr RunQueue::Ordering ordering = RunQueue::BY_REMAINING;
+
+    bool shouldPreempt(Process &process, const RunQueue &queue) const
+    {
+        return queue.peekKey() < static_cast<uint64_t>(process.getLinesOfCode() - process.getCommandCounter());
+    }
+
+    void onInstructionExecuted(Process &) const {}
+    void onPreempt(Process &) const {}
+
+    // Remaining work only shrinks while the process runs, so if the queue
+    // does not preempt it now it will not until the queue changes
+    uint64_t instructionsUntilPreempt(const Process &, const RunQueue &) const { return UINT64_MAX; }
+};
+
+// Completely fair scheduling. Each executed instruction charges the process
+// NICE_0_WEIGHT / weight units of vruntime (scaled by 1024), the ready queues
+// are ordered by vruntime, and the slice is the process's share of a
+// scheduling period, its weight over the summed weight of every runnable
+// process. The period stretches once there are too many runnable processes
+// to give each the minimum granularity.
+struct CFSPolicy
+{
+    CFSPolicy(const Config &config, const std::atomic<size_t> &runnable, const std::atomic<uint64_t> &runnableWeight)
+        : targetLatency(config.getCFSTargetLatency()),
+          minGranularity(config.getCFSMinGranularity()),
+          runnable(&runnable),
+          runnableWeight(&runnableWeight) {}
+
+    static constexpr RunQueue::Ordering ordering = RunQueue::BY_VRUNTIME;
+
+    uint64_t timeSlice(const Process &process) const
+    {
+        uint64_t nrRunnable = std::max<uint64_t>(1, runnable->load(std::memory_order_relaxed));
+        uint64_t totalWeight = std::max<uint64_t>(process.getWeight(), runnableWeight->load(std::memory_order_relaxed));
+        uint64_t period = std::max<uint64_t>(targetLatency, nrRunnable * minGranularity);
+        uint64_t slice = period * process.getWeight() / totalWeight;
+        return std::max<uint64_t>(slice, minGranularity);
+    }
+
+    bool shouldPreempt(Process &process, const RunQueue &) const { return process.getQuantumTime() >= timeSlice(process); }
+
+    void onInstructionExecuted(Process &process) const
+    {
+        process.incrementQuantumTime();
+        process.addVruntime((uint64_t{Process::NICE_0_WEIGHT} << 10) / process.getWeight());
+    }
+
+    void onPreempt(Process &process) const { process.resetQuantumTime(); }
+
+    uint64_t instructionsUntilPreempt(const Process &process, const RunQueue &) const
+    {
+        uint64_t slice = timeSlice(process);
+        return slice - std::min<uint64_t>(process.getQuantumTime(), slice);
+    }
+
+    uint32_t targetLatency;
+    uint32_t minGranularity;
+    const std::atomic<size_t> *runnable;
+    const std::atomic<uint64_t> *runnableWeight;
+};
+
+#endif
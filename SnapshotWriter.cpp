@@ -0,0 +1,117 @@
+#include "SnapshotWriter.h"
+#include <cstring>
+#include <chrono>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+bool SnapshotWriter::start(const std::string &path, bool truncate)
+{
+    stop();
+
+    file = std::fopen(path.c_str(), truncate ? "wb" : "ab");
+    if (file == nullptr)
+        return false;
+
+    // An appended log already has its header
+    std::fseek(file, 0, SEEK_END);
+    if (std::ftell(file) == 0)
+    {
+        SnapshotFileHeader header{};
+        std::memcpy(header.magic, "CSMSNAP1", sizeof(header.magic));
+        header.recordHeaderSize = sizeof(SnapshotRecordHeader);
+        header.blockSize = sizeof(SnapshotBlock);
+        std::fwrite(&header, sizeof(header), 1, file);
+    }
+
+    stopping = false;
+    writerThread = std::thread(&SnapshotWriter::writerLoop, this);
+    return true;
+}
+
+void SnapshotWriter::stop()
+{
+    if (!writerThread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueCv.notify_one();
+    writerThread.join();
+
+    std::fclose(file);
+    file = nullptr;
+}
+
+void SnapshotWriter::submit(MemorySnapshot snapshot)
+{
+    std::lock_guard<std::mutex> lock(queueMutex);
+    if (queue.size() >= MAX_QUEUED)
+    {
+        ++dropped;
+        return;
+    }
+    queue.push_back(std::move(snapshot));
+
+    // Snapshots taken faster than the interval drains them
+    if (queue.size() == MAX_QUEUED / 2)
+    {
+        queueCv.notify_one();
+    }
+}
+
+void SnapshotWriter::writerLoop()
+{
+    // Woken by the interval rather than by every submit, so a burst of
+    // snapshots is written and synced together
+    std::unique_lock<std::mutex> lock(queueMutex);
+    while (true)
+    {
+        queueCv.wait_for(lock, std::chrono::milliseconds(FLUSH_INTERVAL_MS), [this]
+                         { return stopping || queue.size() >= MAX_QUEUED / 2; });
+
+        std::deque<MemorySnapshot> batch;
+        batch.swap(queue);
+        bool finished = stopping;
+        lock.unlock();
+
+        if (!batch.empty())
+        {
+            writeBatch(batch);
+            sync();
+        }
+        if (finished)
+            return;
+        lock.lock();
+    }
+}
+
+void SnapshotWriter::writeBatch(std::deque<MemorySnapshot> &batch)
+{
+    for (const auto &snapshot : batch)
+    {
+        std::fwrite(&snapshot.header, sizeof(snapshot.header), 1, file);
+        if (snapshot.layout)
+        {
+            std::fwrite(snapshot.layout->blocks.data(), sizeof(SnapshotBlock), snapshot.layout->blocks.size(), file);
+            std::fwrite(snapshot.layout->names.data(), 1, snapshot.layout->names.size(), file);
+        }
+        ++written;
+    }
+}
+
+void SnapshotWriter::sync()
+{
+    std::fflush(file);
+#ifdef _WIN32
+    _commit(_fileno(file));
+#else
+    fsync(fileno(file));
+#endif
+    ++syncs;
+}
@@ -0,0 +1,105 @@
+#ifndef SNAPSHOT_WRITER_H
+#define SNAPSHOT_WRITER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdint>
+
+// Memory snapshot log. MemoryManager captures the memory map under its lock
+// as an immutable MemoryLayout, shared by every snapshot taken until the map
+// next changes, and hands it here; the writer thread appends the snapshots to
+// one binary file and syncs it to disk once per flush interval rather than
+// once per snapshot, or sooner when half of MAX_QUEUED is waiting. If the
+// writer still falls behind, snapshots beyond MAX_QUEUED are dropped and
+// counted instead of holding up the cores.
+//
+// The file is a SnapshotFileHeader followed by records, each a
+// SnapshotRecordHeader, blockCount SnapshotBlocks and namesSize bytes of
+// process names. tools/SnapshotDump.cpp turns it back into the
+// memory_stamp_XX.txt files.
+
+struct SnapshotFileHeader
+{
+    char magic[8]; // "CSMSNAP1"
+    uint32_t recordHeaderSize;
+    uint32_t blockSize;
+};
+
+struct SnapshotRecordHeader
+{
+    int64_t timestamp; // Seconds since the epoch
+    uint64_t totalMemory;
+    uint64_t externalFragmentation;
+    uint32_t cycle;
+    uint32_t processCount;
+    uint32_t blockCount;
+    uint32_t namesSize;
+};
+static_assert(sizeof(SnapshotRecordHeader) == 40, "snapshot records are written to disk as-is");
+
+// One occupied range of memory, highest address first
+struct SnapshotBlock
+{
+    uint64_t start;
+    uint64_t end; // One past the last byte
+    uint32_t nameOffset;
+    uint32_t nameLength;
+};
+static_assert(sizeof(SnapshotBlock) == 24, "snapshot records are written to disk as-is");
+
+struct MemoryLayout
+{
+    std::vector<SnapshotBlock> blocks;
+    std::string names;
+};
+
+struct MemorySnapshot
+{
+    SnapshotRecordHeader header;
+    std::shared_ptr<const MemoryLayout> layout;
+};
+
+class SnapshotWriter
+{
+public:
+    static constexpr size_t MAX_QUEUED = 4096;
+    static constexpr int FLUSH_INTERVAL_MS = 50;
+
+    ~SnapshotWriter() { stop(); }
+
+    // truncate starts a new log, otherwise snapshots are appended to it
+    bool start(const std::string &path, bool truncate);
+    void stop(); // Writes and syncs everything queued
+    bool isRunning() const { return writerThread.joinable(); }
+
+    void submit(MemorySnapshot snapshot);
+
+    uint64_t getWritten() const { return written.load(); }
+    uint64_t getDropped() const { return dropped.load(); }
+    uint64_t getSyncs() const { return syncs.load(); }
+
+private:
+    std::FILE *file{nullptr};
+    std::thread writerThread;
+    std::mutex queueMutex;
+    std::condition_variable queueCv;
+    std::deque<MemorySnapshot> queue;
+    bool stopping{false};
+
+    std::atomic<uint64_t> written{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> syncs{0};
+
+    void writerLoop();
+    void writeBatch(std::deque<MemorySnapshot> &batch);
+    void sync();
+};
+
+#endif
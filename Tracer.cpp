@@ -0,0 +1,100 @@
+#include "Tracer.h"
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+
+bool Tracer::start(const std::string &path, size_t numCores)
+{
+    stop();
+
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+
+    TraceFileHeader header{};
+    std::memcpy(header.magic, "CSTRACE1", sizeof(header.magic));
+    header.recordSize = sizeof(TraceRecord);
+    header.numCores = static_cast<uint32_t>(numCores);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    rings.clear();
+    for (size_t i = 0; i < numCores; ++i)
+    {
+        rings.push_back(std::make_unique<Ring>());
+    }
+
+    stopping = false;
+    enabled = true;
+    flushThread = std::thread(&Tracer::flushLoop, this);
+    return true;
+}
+
+void Tracer::stop()
+{
+    if (!flushThread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(flushMutex);
+        stopping = true;
+    }
+    flushCv.notify_one();
+    flushThread.join();
+
+    // Producers are stopped by now, so this picks up the last records
+    enabled = false;
+    drain();
+
+    for (size_t core = 0; core < rings.size(); ++core)
+    {
+        TraceRecord footer{};
+        footer.arg = static_cast<uint32_t>(std::min<uint64_t>(rings[core]->dropped.load(std::memory_order_relaxed), UINT32_MAX));
+        footer.core = static_cast<uint16_t>(core);
+        footer.event = static_cast<uint8_t>(TraceEvent::TRACE_END);
+        file.write(reinterpret_cast<const char *>(&footer), sizeof(footer));
+    }
+    file.close();
+}
+
+uint64_t Tracer::getDroppedRecords() const
+{
+    uint64_t dropped = 0;
+    for (const auto &ring : rings)
+    {
+        dropped += ring->dropped.load(std::memory_order_relaxed);
+    }
+    return dropped;
+}
+
+void Tracer::flushLoop()
+{
+    std::unique_lock<std::mutex> lock(flushMutex);
+    while (!stopping)
+    {
+        flushCv.wait_for(lock, std::chrono::milliseconds(5), [this]
+                         { return stopping; });
+        lock.unlock();
+        drain();
+        lock.lock();
+    }
+}
+
+void Tracer::drain()
+{
+    for (auto &ring : rings)
+    {
+        uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+
+        // At most two contiguous runs: up to the end of the buffer, then from the start
+        while (tail != head)
+        {
+            size_t start = tail & (RING_CAPACITY - 1);
+            size_t length = std::min<uint64_t>(head - tail, RING_CAPACITY - start);
+            file.write(reinterpret_cast<const char *>(&ring->records[start]), length * sizeof(TraceRecord));
+            tail += length;
+        }
+        ring->tail.store(tail, std::memory_order_release);
+    }
+    file.flush();
+}
@@ -0,0 +1,113 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <fstream>
+#include <cstdint>
+
+// Scheduler event trace. Every simulated core gets its own single-producer
+// ring of fixed-size binary records: one thread at a time writes to it (the
+// host worker that owns the core, or the scheduling step between phases
+// while that worker waits at the barrier), and the flush thread is the only
+// reader, so recording is a couple of relaxed loads and a release store with
+// no lock. A full ring drops the record and counts it instead of stalling the
+// core.
+//
+// The flush thread drains the rings every few milliseconds into the trace
+// file, which is a TraceFileHeader followed by raw TraceRecords and, once
+// tracing stops, a footer of one TRACE_END record per core carrying the
+// number of records that core's ring dropped. Convert it with
+// tools/TraceToChrome.cpp to load it in chrome://tracing or Perfetto.
+
+enum class TraceEvent : uint8_t
+{
+    DISPATCH = 1,   // arg: priority level
+    PREEMPT = 2,    // arg: priority level after onPreempt
+    ALLOC_FAIL = 3,  // arg: bytes requested; flat mode, before dispatch
+    FINISH = 4,      // arg: instructions executed
+    PAGE_TOUCH = 5,  // arg: page, | PAGE_TOUCH_WRITE for a store; repeats are skipped
+    PAGE_FAULT = 6,  // arg: page; the process waits for the pager
+    MEMORY_WAIT = 7, // arg: page; every frame is mid-swap, the process leaves its core
+    TRACE_END = 8    // Footer, arg: records dropped by this core's ring (saturating)
+};
+
+constexpr uint32_t PAGE_TOUCH_WRITE = 0x80000000;
+
+struct TraceRecord
+{
+    uint64_t cycle;
+    int32_t pid;
+    uint32_t arg;
+    uint16_t core;
+    uint8_t event;
+    uint8_t reserved[5];
+};
+static_assert(sizeof(TraceRecord) == 24, "trace records are written to disk as-is");
+
+struct TraceFileHeader
+{
+    char magic[8]; // "CSTRACE1"
+    uint32_t recordSize;
+    uint32_t numCores;
+};
+
+class Tracer
+{
+public:
+    static constexpr size_t RING_CAPACITY = 8192; // Records per core, power of two
+
+    ~Tracer() { stop(); }
+
+    bool start(const std::string &path, size_t numCores);
+    void stop(); // Drains the rings and writes the footer
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    void record(int core, TraceEvent event, uint64_t cycle, int pid, uint32_t arg = 0)
+    {
+        Ring &ring = *rings[core];
+        uint64_t head = ring.head.load(std::memory_order_relaxed);
+        if (head - ring.tail.load(std::memory_order_acquire) >= RING_CAPACITY)
+        {
+            ring.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        TraceRecord &slot = ring.records[head & (RING_CAPACITY - 1)];
+        slot.cycle = cycle;
+        slot.pid = pid;
+        slot.arg = arg;
+        slot.core = static_cast<uint16_t>(core);
+        slot.event = static_cast<uint8_t>(event);
+        ring.head.store(head + 1, std::memory_order_release);
+    }
+
+    uint64_t getDroppedRecords() const; // Of the last trace, still valid after stop()
+
+private:
+    struct Ring
+    {
+        alignas(64) std::atomic<uint64_t> head{0};
+        alignas(64) std::atomic<uint64_t> tail{0};
+        std::atomic<uint64_t> dropped{0};
+        std::vector<TraceRecord> records = std::vector<TraceRecord>(RING_CAPACITY);
+    };
+
+    std::vector<std::unique_ptr<Ring>> rings;
+    std::ofstream file;
+    std::atomic<bool> enabled{false};
+    std::thread flushThread;
+    std::mutex flushMutex;
+    std::condition_variable flushCv;
+    bool stopping{false};
+
+    void flushLoop();
+    void drain();
+};
+
+#endif
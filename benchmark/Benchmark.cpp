@@ -0,0 +1,258 @@
+// Headless benchmark for the scheduler and memory manager.
+//
+// Loads a config, feeds a fixed seeded workload through ProcessManager (one
+// arrival every batch-process-freq cycles, like scheduler-test), runs it to
+// completion without the CLI and prints the results as JSON. With
+// clock-mode virtual everything counted in cycles, processes, pages or bytes
+// depends only on the config and seed, whatever host-threads is; host
+// timings (wall_seconds, the _ns and _us figures, snapshot syncs) do not.
+// With the realtime clock idle cycles tick on a host timer, so the cycle
+// counts vary from run to run as well.
+//
+// Usage: benchmark <config file> [--processes N] [--seed S] [--set param=value]...
+
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include "../Config.h"
+#include "../Scheduler.h"
+#include "../ProcessManager.h"
+#include "../MemoryManager.h"
+
+namespace
+{
+    struct Options
+    {
+        std::string configFile;
+        uint64_t processes{1000};
+        uint32_t seed{1};
+        std::vector<std::pair<std::string, std::string>> overrides;
+    };
+
+    void printUsage()
+    {
+        std::cerr << "Usage: benchmark <config file> [--processes N] [--seed S] [--set param=value]...\n";
+    }
+
+    bool parseOptions(int argc, char *argv[], Options &options)
+    {
+        if (argc < 2)
+            return false;
+
+        options.configFile = argv[1];
+        for (int i = 2; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (i + 1 >= argc)
+                return false;
+
+            if (arg == "--processes")
+            {
+                options.processes = std::strtoull(argv[++i], nullptr, 10);
+            }
+            else if (arg == "--seed")
+            {
+                options.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            }
+            else if (arg == "--set")
+            {
+                std::string assignment = argv[++i];
+                size_t equals = assignment.find('=');
+                if (equals == std::string::npos)
+                    return false;
+                options.overrides.push_back({assignment.substr(0, equals), assignment.substr(equals + 1)});
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return options.processes > 0;
+    }
+
+    // Nearest-rank percentile of an already sorted sample
+    uint64_t percentile(const std::vector<uint64_t> &sorted, double p)
+    {
+        if (sorted.empty())
+            return 0;
+
+        size_t rank = static_cast<size_t>(p / 100.0 * sorted.size() + 0.5);
+        rank = std::min(std::max<size_t>(rank, 1), sorted.size());
+        return sorted[rank - 1];
+    }
+
+    void writeLatency(std::ostream &out, const char *name, std::vector<uint64_t> samples, bool last)
+    {
+        std::sort(samples.begin(), samples.end());
+
+        uint64_t total = 0;
+        for (uint64_t sample : samples)
+        {
+            total += sample;
+        }
+
+        out << "    \"" << name << "\": {"
+            << "\"mean\": " << (samples.empty() ? 0 : total / samples.size())
+            << ", \"p50\": " << percentile(samples, 50)
+            << ", \"p90\": " << percentile(samples, 90)
+            << ", \"p99\": " << percentile(samples, 99)
+            << ", \"max\": " << (samples.empty() ? 0 : samples.back())
+            << "}" << (last ? "\n" : ",\n");
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        printUsage();
+        return 2;
+    }
+
+    auto &config = Config::getInstance();
+    try
+    {
+        config.loadConfig(options.configFile);
+        config.setParameter("workload-seed", std::to_string(options.seed));
+        for (const auto &override : options.overrides)
+        {
+            config.setParameter(override.first, override.second);
+        }
+        config.validateParameters();
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Config error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    auto &scheduler = Scheduler::getInstance();
+    auto &processManager = ProcessManager::getInstance();
+
+    // The emulator reports through std::cout; keep it out of the JSON
+    std::ostringstream discarded;
+    std::streambuf *stdoutBuffer = std::cout.rdbuf(discarded.rdbuf());
+
+    auto wallStart = std::chrono::steady_clock::now();
+    scheduler.startScheduling();
+
+    // Every arrival, the first included, is made under a clock hold, so the
+    // clock cannot run past its cycle while the process is being created
+    std::atomic<bool> generating{true};
+    uint64_t arrivalCycle = scheduler.getCPUCycles();
+    for (uint64_t i = 1; i <= options.processes; ++i)
+    {
+        scheduler.waitForCycle(arrivalCycle, generating);
+
+        std::ostringstream name;
+        name << "p" << std::setfill('0') << std::setw(2) << i;
+        processManager.createProcess(name.str());
+        arrivalCycle += config.getBatchProcessFreq();
+    }
+    scheduler.releaseCycle();
+
+    scheduler.waitForFinished(options.processes);
+    auto wallEnd = std::chrono::steady_clock::now();
+    uint64_t cycles = scheduler.getCPUCycles();
+    scheduler.stopScheduling();
+
+    std::cout.rdbuf(stdoutBuffer);
+
+    // Finished processes only survive as summaries, in memory or archived
+    const auto &history = scheduler.getFinishedHistory();
+    std::vector<uint64_t> response;
+    std::vector<uint64_t> waiting;
+    std::vector<uint64_t> turnaround;
+    for (const auto &summary : history.read(0, history.size()))
+    {
+        response.push_back(summary.firstRunCycle - summary.arrivalCycle);
+        waiting.push_back(summary.waitingCycles);
+        turnaround.push_back(summary.finishCycle - summary.arrivalCycle);
+    }
+
+    double wallSeconds = std::chrono::duration<double>(wallEnd - wallStart).count();
+    const auto &memoryManager = MemoryManager::getInstance();
+    auto swapLatency = memoryManager.getSwapLatency().summarize();
+    auto allocationLatency = memoryManager.getAllocationLatency().summarize();
+    auto fragmentation = memoryManager.getFragmentationSamples().summarize();
+    auto compactionStep = memoryManager.getCompactionLatency().summarize();
+    auto snapshotCapture = memoryManager.getSnapshotCaptureLatency().summarize();
+
+    std::cout << "{\n"
+              << "  \"config\": {"
+              << "\"file\": \"" << options.configFile << "\""
+              << ", \"scheduler\": \"" << config.getSchedulerType() << "\""
+              << ", \"num_cpu\": " << config.getNumCPU()
+              << ", \"host_threads\": " << std::min<unsigned int>(config.getHostThreads(), config.getNumCPU())
+              << ", \"clock\": \"" << (config.isVirtualClock() ? "virtual" : "realtime") << "\""
+              << ", \"exec\": \"" << (config.isSliceBatching() ? "slice" : "cycle") << "\""
+              << ", \"memory\": \"" << config.getMemoryMode() << "\""
+              << ", \"placement\": \"" << config.getPlacement() << "\""
+              << ", \"compaction_frames\": " << config.getCompactionFrames()
+              << ", \"page_replacement\": \"" << config.getPageReplacement() << "\""
+              << ", \"processes\": " << options.processes
+              << ", \"seed\": " << options.seed << "},\n"
+              << std::fixed << std::setprecision(3)
+              << "  \"wall_seconds\": " << wallSeconds << ",\n"
+              << "  \"cycles\": " << cycles << ",\n"
+              << "  \"cycles_per_second\": " << (wallSeconds > 0 ? cycles / wallSeconds : 0.0) << ",\n"
+              << "  \"finished\": " << scheduler.getFinishedCount() << ",\n"
+              << "  \"context_switches\": " << scheduler.getContextSwitches() << ",\n"
+              << "  \"allocation_failures\": " << memoryManager.getAllocationFailures() << ",\n"
+              << "  \"allocation\": {"
+              << "\"attempts\": " << memoryManager.getAllocationAttempts()
+              << ", \"failure_rate\": " << (memoryManager.getAllocationAttempts() > 0
+                                                 ? static_cast<double>(memoryManager.getAllocationFailures()) / memoryManager.getAllocationAttempts()
+                                                 : 0.0)
+              << ", \"latency_ns\": {\"mean\": " << allocationLatency.mean
+              << ", \"p50\": " << allocationLatency.p50
+              << ", \"p99\": " << allocationLatency.p99
+              << ", \"max\": " << allocationLatency.max << "}"
+              << ", \"external_fragmentation_bytes\": {\"mean\": " << fragmentation.mean
+              << ", \"p50\": " << fragmentation.p50
+              << ", \"p99\": " << fragmentation.p99
+              << ", \"max\": " << fragmentation.max << "}},\n"
+              << "  \"compaction\": {"
+              << "\"runs\": " << memoryManager.getCompactionRuns()
+              << ", \"failures_avoided\": " << memoryManager.getFailuresAvoided()
+              << ", \"blocks_moved\": " << memoryManager.getBlocksMoved()
+              << ", \"bytes_moved\": " << memoryManager.getBytesMoved()
+              << ", \"time_ns\": " << memoryManager.getCompactionTime()
+              << ", \"step_ns\": {\"mean\": " << compactionStep.mean
+              << ", \"p99\": " << compactionStep.p99
+              << ", \"max\": " << compactionStep.max << "}},\n"
+              << "  \"snapshots\": {"
+              << "\"written\": " << memoryManager.getSnapshotWriter().getWritten()
+              << ", \"dropped\": " << memoryManager.getSnapshotWriter().getDropped()
+              << ", \"syncs\": " << memoryManager.getSnapshotWriter().getSyncs()
+              << ", \"capture_ns\": {\"mean\": " << snapshotCapture.mean
+              << ", \"p99\": " << snapshotCapture.p99
+              << ", \"max\": " << snapshotCapture.max << "}},\n"
+              << "  \"trace\": {"
+              << "\"file\": \"" << config.getTraceFile() << "\""
+              << ", \"dropped_records\": " << scheduler.getTraceDroppedRecords() << "},\n"
+              << "  \"page_faults\": " << memoryManager.getPageFaults() << ",\n"
+              << "  \"evictions\": " << memoryManager.getEvictions() << ",\n"
+              << "  \"pages_in\": " << memoryManager.getPagesIn() << ",\n"
+              << "  \"pages_out\": " << memoryManager.getPagesOut() << ",\n"
+              << "  \"swap_latency_us\": {"
+              << "\"mean\": " << swapLatency.mean
+              << ", \"p50\": " << swapLatency.p50
+              << ", \"p99\": " << swapLatency.p99
+              << ", \"max\": " << swapLatency.max << "},\n"
+              << "  \"latency_cycles\": {\n";
+    writeLatency(std::cout, "response", response, false);
+    writeLatency(std::cout, "waiting", waiting, false);
+    writeLatency(std::cout, "turnaround", turnaround, true);
+    std::cout << "  }\n"
+              << "}\n";
+
+    return 0;
+}
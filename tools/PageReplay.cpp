@@ -0,0 +1,336 @@
+// Replays the page references of a scheduler trace (trace-file in config.txt,
+// recorded with memory-mode paging) against a given number of frames under
+// every replacement policy, including the optimal one (Belady: evict the page
+// whose next use is furthest away), which can only be run offline since it
+// needs the future reference string. Gives a lower bound to compare the live
+// fifo, lru and clock policies against.
+//
+// References from all cores are merged by cycle. The trace skips a core's
+// repeated accesses to the same page, so fault rates here are per recorded
+// reference rather than per instruction as in vmstat. A page counts as dirty
+// from its first load until it is written back, and again after any store,
+// so the writeback counts follow the live backing store. Pages of a finished
+// process are dropped without counting as evictions.
+//
+// Usage: page_replay <trace file> <frames>
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <list>
+#include <set>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include "../Tracer.h"
+
+namespace
+{
+    struct Reference
+    {
+        uint64_t cycle;
+        uint64_t key;  // pid << 32 | page, or pid << 32 for a finish
+        bool finish;
+        bool write;
+    };
+
+    constexpr size_t NEVER = SIZE_MAX;
+
+    uint64_t keyOf(int32_t pid, uint32_t page)
+    {
+        return static_cast<uint64_t>(static_cast<uint32_t>(pid)) << 32 | page;
+    }
+
+    // Victim choice only; residency, dirtiness and counting are shared
+    class Policy
+    {
+    public:
+        virtual ~Policy() = default;
+        virtual const char *name() const = 0;
+        virtual void onLoad(uint64_t key, size_t position) = 0;
+        virtual void onHit(uint64_t key, size_t position) = 0;
+        virtual void onRemove(uint64_t key) = 0;
+        virtual uint64_t victim() = 0;
+    };
+
+    class FIFOPolicy : public Policy
+    {
+    public:
+        const char *name() const override { return "fifo"; }
+        void onLoad(uint64_t key, size_t) override { positions[key] = order.insert(order.end(), key); }
+        void onHit(uint64_t, size_t) override {}
+        void onRemove(uint64_t key) override
+        {
+            order.erase(positions[key]);
+            positions.erase(key);
+        }
+        uint64_t victim() override { return order.front(); }
+
+    protected:
+        std::list<uint64_t> order;
+        std::unordered_map<uint64_t, std::list<uint64_t>::iterator> positions;
+    };
+
+    // Exact LRU, the policy the live aging approximation aims for
+    class LRUPolicy : public FIFOPolicy
+    {
+    public:
+        const char *name() const override { return "lru"; }
+        void onHit(uint64_t key, size_t) override { order.splice(order.end(), order, positions[key]); }
+    };
+
+    class ClockPolicy : public Policy
+    {
+    public:
+        explicit ClockPolicy(size_t frames) : slots(frames) {}
+
+        const char *name() const override { return "clock"; }
+
+        void onLoad(uint64_t key, size_t) override
+        {
+            size_t slot = freeSlots.empty() ? used++ : freeSlots.back();
+            if (!freeSlots.empty())
+                freeSlots.pop_back();
+            slots[slot] = {key, true, true};
+            positions[key] = slot;
+        }
+
+        void onHit(uint64_t key, size_t) override { slots[positions[key]].referenced = true; }
+
+        void onRemove(uint64_t key) override
+        {
+            size_t slot = positions[key];
+            slots[slot].occupied = false;
+            freeSlots.push_back(slot);
+            positions.erase(key);
+        }
+
+        uint64_t victim() override
+        {
+            while (true)
+            {
+                Slot &slot = slots[hand];
+                hand = (hand + 1) % slots.size();
+                if (!slot.occupied)
+                    continue;
+                if (!slot.referenced)
+                    return slot.key;
+                slot.referenced = false;
+            }
+        }
+
+    private:
+        struct Slot
+        {
+            uint64_t key{0};
+            bool referenced{false};
+            bool occupied{false};
+        };
+
+        std::vector<Slot> slots;
+        std::vector<size_t> freeSlots;
+        std::unordered_map<uint64_t, size_t> positions;
+        size_t used{0};
+        size_t hand{0};
+    };
+
+    class OptimalPolicy : public Policy
+    {
+    public:
+        explicit OptimalPolicy(const std::vector<size_t> &nextUse) : nextUse(nextUse) {}
+
+        const char *name() const override { return "opt"; }
+        void onLoad(uint64_t key, size_t position) override { update(key, position); }
+        void onHit(uint64_t key, size_t position) override { update(key, position); }
+        void onRemove(uint64_t key) override
+        {
+            byNextUse.erase({current[key], key});
+            current.erase(key);
+        }
+        uint64_t victim() override { return std::prev(byNextUse.end())->second; }
+
+    private:
+        const std::vector<size_t> &nextUse;
+        std::set<std::pair<size_t, uint64_t>> byNextUse;
+        std::unordered_map<uint64_t, size_t> current;
+
+        void update(uint64_t key, size_t position)
+        {
+            auto known = current.find(key);
+            if (known != current.end())
+            {
+                byNextUse.erase({known->second, key});
+            }
+            current[key] = nextUse[position];
+            byNextUse.insert({nextUse[position], key});
+        }
+    };
+
+    struct Result
+    {
+        uint64_t references{0};
+        uint64_t faults{0};
+        uint64_t evictions{0};
+        uint64_t writebacks{0};
+    };
+
+    Result replay(const std::vector<Reference> &references, size_t frames, Policy &policy)
+    {
+        Result result;
+        std::unordered_map<uint64_t, bool> resident; // key -> dirty
+        std::unordered_set<uint64_t> swapped;        // Has a current copy in the backing store
+
+        for (size_t position = 0; position < references.size(); ++position)
+        {
+            const Reference &reference = references[position];
+            if (reference.finish)
+            {
+                for (auto it = resident.begin(); it != resident.end();)
+                {
+                    if (it->first >> 32 == reference.key >> 32)
+                    {
+                        policy.onRemove(it->first);
+                        it = resident.erase(it);
+                    }
+                    else
+                    {
+                        ++it;
+                    }
+                }
+                continue;
+            }
+
+            ++result.references;
+            auto page = resident.find(reference.key);
+            if (page != resident.end())
+            {
+                page->second = page->second || reference.write;
+                policy.onHit(reference.key, position);
+                continue;
+            }
+
+            ++result.faults;
+            if (resident.size() >= frames)
+            {
+                uint64_t victim = policy.victim();
+                policy.onRemove(victim);
+                ++result.evictions;
+                if (resident[victim] || swapped.count(victim) == 0)
+                {
+                    ++result.writebacks;
+                    swapped.insert(victim);
+                }
+                resident.erase(victim);
+            }
+
+            // A page loaded from the backing store is clean until written
+            bool dirty = swapped.count(reference.key) == 0 || reference.write;
+            resident[reference.key] = dirty;
+            policy.onLoad(reference.key, position);
+        }
+        return result;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: page_replay <trace file> <frames>\n";
+        return 2;
+    }
+
+    size_t frames = std::strtoull(argv[2], nullptr, 10);
+    if (frames == 0)
+    {
+        std::cerr << "Frames must be at least 1\n";
+        return 2;
+    }
+
+    std::ifstream in(argv[1], std::ios::binary);
+    TraceFileHeader header{};
+    if (!in.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, "CSTRACE1", sizeof(header.magic)) != 0 ||
+        header.recordSize != sizeof(TraceRecord))
+    {
+        std::cerr << "Not a scheduler trace: " << argv[1] << "\n";
+        return 1;
+    }
+
+    std::vector<Reference> references;
+    uint64_t dropped = 0;
+    TraceRecord record;
+    while (in.read(reinterpret_cast<char *>(&record), sizeof(record)))
+    {
+        auto event = static_cast<TraceEvent>(record.event);
+        if (event == TraceEvent::PAGE_TOUCH)
+        {
+            references.push_back({record.cycle, keyOf(record.pid, record.arg & ~PAGE_TOUCH_WRITE), false,
+                                  (record.arg & PAGE_TOUCH_WRITE) != 0});
+        }
+        else if (event == TraceEvent::FINISH)
+        {
+            references.push_back({record.cycle, keyOf(record.pid, 0), true, false});
+        }
+        else if (event == TraceEvent::TRACE_END)
+        {
+            dropped += record.arg;
+        }
+    }
+    if (dropped > 0)
+    {
+        std::cerr << "Warning: the trace dropped " << dropped << " records, so the replay misses some references\n";
+    }
+
+    if (references.empty())
+    {
+        std::cerr << "No page references in " << argv[1] << " (was it recorded with memory-mode paging?)\n";
+        return 1;
+    }
+
+    // Each core's records are in order but the cores are flushed in chunks;
+    // within a cycle, a finish goes after that cycle's references
+    std::stable_sort(references.begin(), references.end(), [](const Reference &a, const Reference &b)
+                     { return a.cycle != b.cycle ? a.cycle < b.cycle : !a.finish && b.finish; });
+
+    std::vector<size_t> nextUse(references.size(), NEVER);
+    {
+        std::unordered_map<uint64_t, size_t> upcoming;
+        for (size_t position = references.size(); position > 0; --position)
+        {
+            const Reference &reference = references[position - 1];
+            if (reference.finish)
+                continue;
+
+            auto next = upcoming.find(reference.key);
+            nextUse[position - 1] = next != upcoming.end() ? next->second : NEVER;
+            upcoming[reference.key] = position - 1;
+        }
+    }
+
+    std::vector<std::unique_ptr<Policy>> policies;
+    policies.push_back(std::make_unique<FIFOPolicy>());
+    policies.push_back(std::make_unique<LRUPolicy>());
+    policies.push_back(std::make_unique<ClockPolicy>(frames));
+    policies.push_back(std::make_unique<OptimalPolicy>(nextUse));
+
+    std::cout << std::left << std::setw(8) << "Policy" << std::right
+              << std::setw(12) << "Faults" << std::setw(12) << "Fault %"
+              << std::setw(12) << "Evictions" << std::setw(12) << "Writebacks" << "\n";
+    for (auto &policy : policies)
+    {
+        Result result = replay(references, frames, *policy);
+        std::cout << std::left << std::setw(8) << policy->name() << std::right
+                  << std::setw(12) << result.faults
+                  << std::setw(12) << std::fixed << std::setprecision(2)
+                  << (result.references > 0 ? 100.0 * result.faults / result.references : 0.0)
+                  << std::setw(12) << result.evictions
+                  << std::setw(12) << result.writebacks << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,81 @@
+// Writes the memory snapshot log (snapshot-log in config.txt) back out as
+// the memory_stamp_XX.txt files, one per snapshot, named by the cycle it was
+// taken at. A log appended to by several scheduler runs holds the same cycle
+// numbers more than once; like the live stamps, the later run's file wins.
+//
+// Usage: snapshot_dump <snapshot log> [output directory, default memory_stamps]
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <filesystem>
+#include "../SnapshotWriter.h"
+#include "../Utils.h"
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: snapshot_dump <snapshot log> [output directory]\n";
+        return 2;
+    }
+    std::string directory = argc > 2 ? argv[2] : "memory_stamps";
+
+    std::ifstream in(argv[1], std::ios::binary);
+    SnapshotFileHeader header{};
+    if (!in.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, "CSMSNAP1", sizeof(header.magic)) != 0 ||
+        header.recordHeaderSize != sizeof(SnapshotRecordHeader) || header.blockSize != sizeof(SnapshotBlock))
+    {
+        std::cerr << "Not a memory snapshot log: " << argv[1] << "\n";
+        return 1;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+
+    size_t count = 0;
+    SnapshotRecordHeader record;
+    std::vector<SnapshotBlock> blocks;
+    std::string names;
+    while (in.read(reinterpret_cast<char *>(&record), sizeof(record)))
+    {
+        blocks.resize(record.blockCount);
+        names.resize(record.namesSize);
+        if (!in.read(reinterpret_cast<char *>(blocks.data()), blocks.size() * sizeof(SnapshotBlock)) ||
+            !in.read(&names[0], names.size()))
+        {
+            std::cerr << "Log ends in the middle of a snapshot, stopping after " << count << "\n";
+            break;
+        }
+
+        std::stringstream filename;
+        filename << directory << "/memory_stamp_" << std::setw(2) << std::setfill('0') << record.cycle << ".txt";
+        std::ofstream file(filename.str());
+        if (!file)
+        {
+            std::cerr << "Could not write " << filename.str() << "\n";
+            return 1;
+        }
+
+        file << "Timestamp: " << formatTimestamp(std::chrono::system_clock::from_time_t(static_cast<std::time_t>(record.timestamp))) << "\n";
+        file << "Number of processes in memory: " << record.processCount << "\n";
+        file << "Total external fragmentation in KB: " << record.externalFragmentation / 1024 << "\n\n";
+        file << "----end---- = " << record.totalMemory << "\n\n";
+        for (const auto &block : blocks)
+        {
+            file << block.end << "\n";
+            file << names.substr(block.nameOffset, block.nameLength) << "\n";
+            file << block.start << "\n\n";
+        }
+        file << "----start---- = 0\n";
+        ++count;
+    }
+
+    std::cout << "Wrote " << count << " memory stamps to " << directory << "\n";
+    return 0;
+}
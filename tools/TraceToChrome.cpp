@@ -0,0 +1,209 @@
+// Converts a binary scheduler trace (trace-file in config.txt) into the
+// Chrome trace event JSON format, viewable in chrome://tracing or
+// ui.perfetto.dev. Each simulated core becomes a track; a process's time on
+// a core is one slice from dispatch to preemption, finish, a page fault that
+// waits for swap I/O or a wait for a free frame, and failed memory
+// allocations show up as instant markers. Records a core's ring dropped are
+// marked at the end of its track, since the slices around them may be wrong.
+// One cycle is shown as one microsecond.
+//
+// Usage: trace_to_chrome <trace file> [output.json]
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <algorithm>
+#include "../Tracer.h"
+
+namespace
+{
+    struct OpenSlice
+    {
+        bool open{false};
+        uint64_t start{0};
+        int32_t pid{0};
+        uint32_t level{0};
+    };
+
+    class ChromeWriter
+    {
+    public:
+        explicit ChromeWriter(std::ostream &out) : out(out)
+        {
+            out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n";
+        }
+
+        ~ChromeWriter()
+        {
+            out << "\n]}\n";
+        }
+
+        void threadName(uint32_t core)
+        {
+            begin();
+            out << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": " << core
+                << ", \"args\": {\"name\": \"Core " << core << "\"}}";
+        }
+
+        void slice(uint32_t core, const OpenSlice &slice, uint64_t end, const char *reason)
+        {
+            begin();
+            out << "{\"name\": \"pid " << slice.pid << "\", \"cat\": \"run\", \"ph\": \"X\", \"pid\": 0, \"tid\": " << core
+                << ", \"ts\": " << slice.start << ", \"dur\": " << end - slice.start
+                << ", \"args\": {\"pid\": " << slice.pid << ", \"level\": " << slice.level
+                << ", \"end\": \"" << reason << "\"}}";
+        }
+
+        void instant(uint32_t core, const char *name, const TraceRecord &record, const char *argName)
+        {
+            begin();
+            out << "{\"name\": \"" << name << "\", \"cat\": \"sched\", \"ph\": \"i\", \"s\": \"t\", \"pid\": 0, \"tid\": " << core
+                << ", \"ts\": " << record.cycle
+                << ", \"args\": {\"pid\": " << record.pid << ", \"" << argName << "\": " << record.arg << "}}";
+        }
+
+    private:
+        std::ostream &out;
+        bool first{true};
+
+        void begin()
+        {
+            if (!first)
+                out << ",\n";
+            first = false;
+        }
+    };
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: trace_to_chrome <trace file> [output.json]\n";
+        return 2;
+    }
+
+    std::ifstream in(argv[1], std::ios::binary);
+    TraceFileHeader header{};
+    if (!in.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, "CSTRACE1", sizeof(header.magic)) != 0 ||
+        header.recordSize != sizeof(TraceRecord))
+    {
+        std::cerr << "Not a scheduler trace: " << argv[1] << "\n";
+        return 1;
+    }
+
+    std::ofstream file;
+    if (argc > 2)
+    {
+        file.open(argv[2]);
+        if (!file.is_open())
+        {
+            std::cerr << "Could not open " << argv[2] << "\n";
+            return 1;
+        }
+    }
+    std::ostream &out = argc > 2 ? file : std::cout;
+
+    uint64_t records = 0;
+    uint64_t dropped = 0;
+    uint64_t lastCycle = 0;
+    std::vector<OpenSlice> slices(header.numCores);
+    {
+        ChromeWriter writer(out);
+        for (uint32_t core = 0; core < header.numCores; ++core)
+        {
+            writer.threadName(core);
+        }
+
+        // Records of one core are in the order that core produced them, so
+        // slices can be paired in a single pass
+        TraceRecord record;
+        while (in.read(reinterpret_cast<char *>(&record), sizeof(record)))
+        {
+            if (record.core >= header.numCores)
+                continue;
+
+            // The footer comes after every other record
+            if (static_cast<TraceEvent>(record.event) == TraceEvent::TRACE_END)
+            {
+                if (record.arg > 0)
+                {
+                    record.cycle = lastCycle;
+                    writer.instant(record.core, "records dropped", record, "count");
+                }
+                dropped += record.arg;
+                continue;
+            }
+
+            ++records;
+            lastCycle = std::max(lastCycle, record.cycle);
+            OpenSlice &open = slices[record.core];
+            switch (static_cast<TraceEvent>(record.event))
+            {
+            case TraceEvent::DISPATCH:
+                if (open.open)
+                    writer.slice(record.core, open, record.cycle, "unknown");
+                open = {true, record.cycle, record.pid, record.arg};
+                break;
+            case TraceEvent::PREEMPT:
+                if (open.open && open.pid == record.pid)
+                {
+                    writer.slice(record.core, open, record.cycle, "preempt");
+                    open.open = false;
+                }
+                else
+                {
+                    writer.instant(record.core, "requeue", record, "level");
+                }
+                break;
+            case TraceEvent::FINISH:
+                if (open.open && open.pid == record.pid)
+                {
+                    writer.slice(record.core, open, record.cycle, "finish");
+                    open.open = false;
+                }
+                break;
+            case TraceEvent::ALLOC_FAIL:
+                writer.instant(record.core, "alloc fail", record, "bytes");
+                break;
+            case TraceEvent::PAGE_FAULT:
+                if (open.open && open.pid == record.pid)
+                {
+                    writer.slice(record.core, open, record.cycle, "page fault");
+                    open.open = false;
+                }
+                break;
+            case TraceEvent::MEMORY_WAIT:
+                if (open.open && open.pid == record.pid)
+                {
+                    writer.slice(record.core, open, record.cycle, "memory wait");
+                    open.open = false;
+                }
+                writer.instant(record.core, "no free frame", record, "page");
+                break;
+            case TraceEvent::TRACE_END:
+                break;
+            case TraceEvent::PAGE_TOUCH:
+                // Too many to draw; tools/PageReplay.cpp replays them
+                break;
+            }
+        }
+
+        // Still running when the trace stopped
+        for (uint32_t core = 0; core < header.numCores; ++core)
+        {
+            if (slices[core].open)
+                writer.slice(core, slices[core], lastCycle, "stopped");
+        }
+    }
+
+    std::cerr << "Converted " << records << " records\n";
+    if (dropped > 0)
+    {
+        std::cerr << "The trace is missing " << dropped << " records its rings dropped\n";
+    }
+    return 0;
+}